@@ -0,0 +1,282 @@
+/* 性能测试 - 测量 libbgt 各个热点路径的耗时，结果以 JSON 格式输出到标准输出 */
+
+// 用法：xmake run bench > result.json
+// 进度与说明输出到标准错误，不影响 JSON 结果
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "libbgt.h"
+#include <internal/pixel_kernels.h>
+
+using namespace std;
+
+// ==========================================
+// 内存分配计数：只统计 C++ 的 operator new，SDL 内部的 malloc 不计入
+// ==========================================
+namespace {
+atomic<unsigned long long> allocation_count{ 0 };
+
+void* counted_alloc(size_t size) {
+	allocation_count.fetch_add(1, memory_order_relaxed);
+	if (void* p = malloc(size ? size : 1)) {
+		return p;
+	}
+	throw bad_alloc();
+}
+} // namespace
+
+void* operator new(size_t size) {
+	return counted_alloc(size);
+}
+
+void* operator new[](size_t size) {
+	return counted_alloc(size);
+}
+
+void operator delete(void* p) noexcept {
+	free(p);
+}
+
+void operator delete[](void* p) noexcept {
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+	free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+	free(p);
+}
+
+namespace {
+constexpr double kMinSeconds = 0.2;
+constexpr int kCanvasWidth = 1280;
+constexpr int kCanvasHeight = 720;
+
+struct Result {
+	string name;
+	double ns_per_op;
+	double ops_per_s;
+	double allocs_per_op;
+	// 像素内核的测试额外给出每秒处理的百万像素数
+	double mpixels_per_s = 0;
+};
+
+vector<Result> results;
+
+// 反复执行 op 直到累计时间足够长；每轮执行次数翻倍，以减少读取时钟的开销
+template <typename Op>
+void measure(const string& name, Op op) {
+	using clock = chrono::steady_clock;
+	op(); // 预热，让各种缓存进入稳定状态
+	long long ops = 0;
+	long long batch = 1;
+	unsigned long long allocations = allocation_count.load();
+	auto start = clock::now();
+	double elapsed = 0;
+	do {
+		for (long long i = 0; i < batch; i++) {
+			op();
+		}
+		ops += batch;
+		batch *= 2;
+		elapsed = chrono::duration<double>(clock::now() - start).count();
+	} while (elapsed < kMinSeconds);
+	allocations = allocation_count.load() - allocations;
+
+	results.push_back({ name, elapsed * 1e9 / ops, ops / elapsed, double(allocations) / ops });
+	cerr << left << setw(40) << name << right << fixed << setprecision(1) << setw(12)
+		<< results.back().ns_per_op << " ns/op\n";
+}
+
+// 固定种子的随机数，保证每次运行绘制的内容相同
+mt19937 rng(42);
+
+int random_int(int lo, int hi) {
+	return uniform_int_distribution<int>(lo, hi)(rng);
+}
+
+void bench_primitives() {
+	measure("rectangle/32x32", [] {
+		bgt_rectangle(random_int(0, kCanvasWidth - 32), random_int(0, kCanvasHeight - 32), 32, 32,
+			random_int(0, 255), 128, 64, BGT_ALPHA_OPAQUE, false);
+	});
+	measure("rectangle/32x32/translucent", [] {
+		bgt_rectangle(random_int(0, kCanvasWidth - 32), random_int(0, kCanvasHeight - 32), 32, 32,
+			random_int(0, 255), 128, 64, 128, false);
+	});
+	measure("line/random", [] {
+		bgt_line(random_int(0, kCanvasWidth), random_int(0, kCanvasHeight),
+			random_int(0, kCanvasWidth), random_int(0, kCanvasHeight), 255, 255, 255, BGT_ALPHA_OPAQUE, false);
+	});
+	for (int radius : { 4, 32, 128, 300 }) {
+		measure("circle/r" + to_string(radius), [radius] {
+			bgt_circle(kCanvasWidth / 2, kCanvasHeight / 2, radius, random_int(0, 255), 200, 100,
+				BGT_ALPHA_OPAQUE, false);
+		});
+	}
+	measure("cls", [] {
+		bgt_cls(0, 0, 0, false);
+	});
+}
+
+void bench_text() {
+	measure("show_str/ascii", [] {
+		bgt_show_str(10, 10, "Hello, libbgt! 0123456789", 255, 255, 255, BGT_ALPHA_OPAQUE, false);
+	});
+	measure("show_str/cjk/cached", [] {
+		bgt_show_str(10, 40, "同济大学高级语言程序设计", 255, 255, 255, BGT_ALPHA_OPAQUE, false);
+	});
+	// 每次都是新的字符串，文本缓存必然不命中
+	// 字符串事先生成，拼接字符串的耗时与内存分配不计入结果。用完一轮从头再来时，
+	// 早先的字符串早已被挤出文本缓存（缓存只放得下几百段这样的文字），仍然不会命中
+	vector<string> fresh_strings(1 << 16);
+	for (size_t i = 0; i < fresh_strings.size(); i++) {
+		fresh_strings[i] = "第 " + to_string(i) + " 帧";
+	}
+	size_t next_string = 0;
+	measure("show_str/cjk/uncached", [&] {
+		const string& str = fresh_strings[next_string++ % fresh_strings.size()];
+		bgt_show_str(10, 70, str.c_str(), 255, 255, 255, BGT_ALPHA_OPAQUE, false);
+	});
+	measure("measure_text/ascii", [] {
+		bgt_measure_text("Hello, libbgt! 0123456789");
+	});
+	measure("measure_text/cjk", [] {
+		bgt_measure_text("同济大学高级语言程序设计");
+	});
+	measure("bgt_cout/float", [] {
+		bgt_cout(10, 100, 255, 255, 0, BGT_ALPHA_OPAQUE, false) << "PI = " << fixed << setprecision(2) << 3.1415926;
+	});
+}
+
+void bench_input() {
+	measure("read_keyboard_and_mouse/empty", [] {
+		int mouse_x, mouse_y, mouse_action, keycode, key_modifier;
+		bgt_read_keyboard_and_mouse(mouse_x, mouse_y, mouse_action, keycode, key_modifier);
+	});
+	measure("update_input_state", [] {
+		bgt_update_input_state();
+	});
+}
+
+// 刷新需要真实的窗口；没有显示器的环境下跳过
+void bench_flush() {
+	const int sizes[][2] = { { 640, 480 }, { 1280, 720 }, { 1920, 1080 } };
+	for (const auto& size : sizes) {
+		const int w = size[0], h = size[1];
+		if (!bgt_init(w, h, "libbgt bench")) {
+			cerr << "flush: cannot create a " << w << "x" << h << " window (" << bgt_get_error() << "), skipped\n";
+			bgt_quit();
+			return;
+		}
+		const string suffix = "/" + to_string(w) + "x" + to_string(h);
+		measure("flush/small_change" + suffix, [w, h] {
+			bgt_rectangle(random_int(0, w - 16), random_int(0, h - 16), 16, 16, 255, 0, 0, BGT_ALPHA_OPAQUE, false);
+			bgt_flush();
+		});
+		measure("flush/full_canvas" + suffix, [] {
+			bgt_cls(random_int(0, 255), 0, 0, false);
+			bgt_flush();
+		});
+		measure("flush/nothing_changed" + suffix, [] {
+			bgt_flush();
+		});
+		bgt_quit();
+	}
+}
+
+struct ModeInfo {
+	SDL_BlendMode mode;
+	const char* name;
+};
+
+const ModeInfo kModes[] = {
+	{ SDL_BLENDMODE_NONE, "NONE" },
+	{ SDL_BLENDMODE_BLEND, "BLEND" },
+	{ SDL_BLENDMODE_BLEND_PREMULTIPLIED, "BLEND_PREMULTIPLIED" },
+	{ SDL_BLENDMODE_ADD, "ADD" },
+	{ SDL_BLENDMODE_ADD_PREMULTIPLIED, "ADD_PREMULTIPLIED" },
+	{ SDL_BLENDMODE_MOD, "MOD" },
+	{ SDL_BLENDMODE_MUL, "MUL" },
+};
+
+// 直接调用内部的像素混合内核，每次操作处理一整个 1920x1080 的画布
+void bench_pixel_kernels() {
+	constexpr int w = 1920, h = 1080;
+	vector<Uint32> canvas(size_t(w) * h), sprite(canvas.size());
+	for (auto& p : canvas) {
+		p = rng();
+	}
+	for (auto& p : sprite) {
+		p = rng();
+	}
+
+	cerr << "pixel kernels, best ISA: " << pixelIsaName(bestPixelIsa()) << "\n";
+	for (const auto& mode : kModes) {
+		for (auto isa : { PixelIsa::Scalar, PixelIsa::SSE2, PixelIsa::AVX2 }) {
+			const PixelKernels* kernels = pixelKernels(mode.mode, isa);
+			if (!kernels) {
+				continue;
+			}
+			const string suffix = string("/") + mode.name + "/" + pixelIsaName(isa);
+			// 半透明的颜色，保证混合的每一步都真的会执行
+			measure("pixels/fill" + suffix, [&] {
+				for (int y = 0; y < h; y++) {
+					kernels->fill(canvas.data() + size_t(y) * w, w, 0x3080C0A0u);
+				}
+			});
+			results.back().mpixels_per_s = results.back().ops_per_s * w * h / 1e6;
+			measure("pixels/blit" + suffix, [&] {
+				for (int y = 0; y < h; y++) {
+					kernels->blit(canvas.data() + size_t(y) * w, sprite.data() + size_t(y) * w, w);
+				}
+			});
+			results.back().mpixels_per_s = results.back().ops_per_s * w * h / 1e6;
+		}
+	}
+}
+
+void print_json() {
+	cout << "{\n  \"benchmarks\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result& r = results[i];
+		cout << "    {\"name\": \"" << r.name << "\", " << fixed << setprecision(2)
+			<< "\"ns_per_op\": " << r.ns_per_op << ", "
+			<< "\"ops_per_s\": " << r.ops_per_s << ", "
+			<< "\"allocs_per_op\": " << setprecision(4) << r.allocs_per_op;
+		if (r.mpixels_per_s > 0) {
+			cout << ", \"mpixels_per_s\": " << setprecision(1) << r.mpixels_per_s;
+		}
+		cout << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	cout << "  ]\n}\n";
+}
+} // namespace
+
+int main() {
+	if (!bgt_init_headless(kCanvasWidth, kCanvasHeight)) {
+		cerr << "bgt_init_headless failed: " << bgt_get_error() << "\n";
+		return 1;
+	}
+	bench_primitives();
+	bench_text();
+	bench_input();
+	bgt_quit();
+
+	bench_flush();
+	bench_pixel_kernels();
+
+	print_json();
+	return 0;
+}
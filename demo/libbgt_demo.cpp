@@ -244,20 +244,23 @@ void demo_mouse_events() {
 }
 
 // 演示5：键盘事件和混合模式
-void demo5_draw_background() {
+// 背景不会变化，只在图层上画一次，之后每次重绘时整体合成到画布上
+int demo5_create_background() {
+    int background = bgt_create_layer();
+    bgt_set_draw_layer(background);
+    bgt_cls(40, 40, 60, false);
     // 绘制一些背景图形用于测试混合效果
     for (int i = 0; i < 5; i++) {
         bgt_circle(200 + i * 120, 200, 40, 255, 100, 100, 100, false);  // 半透明红色圆形
         bgt_rectangle(150 + i * 120, 400, 80, 60, 100, 255, 100, 100, false);  // 半透明绿色矩形
     }
+    bgt_set_draw_layer(BGT_CANVAS);
+    return background;
 }
 
-void demo5_draw_scene(int box_x, int box_y, int box_size, unsigned int blend_mode) {
-	// 先清除整个屏幕
-	bgt_cls(40, 40, 60);
-
-	// 重新绘制背景图形
-    demo5_draw_background();
+void demo5_draw_scene(int background, int box_x, int box_y, int box_size, unsigned int blend_mode) {
+	// 背景图层是不透明的，直接覆盖整个画布，相当于清屏后重新绘制背景图形
+	bgt_composite_layer(background, 0, 0, BGT_ALPHA_OPAQUE, BGT_BLENDMODE_NONE, false);
 
     // 在绘制方块的时候使用不同混合模式
 	bgt_set_blend_mode(blend_mode);
@@ -309,7 +312,8 @@ void demo_keyboard_and_blend() {
     unsigned int blend_mode = BGT_BLENDMODE_BLEND;
 
     // 初始绘制
-    demo5_draw_scene(box_x, box_y, box_size, blend_mode);
+    int background = demo5_create_background();
+    demo5_draw_scene(background, box_x, box_y, box_size, blend_mode);
 
     bool running = true;
 
@@ -355,8 +359,9 @@ void demo_keyboard_and_blend() {
         if (box_y > 600 - box_size) box_y = 600 - box_size;
 
         // 重新绘制整个场景
-        demo5_draw_scene(box_x, box_y, box_size, blend_mode);
+        demo5_draw_scene(background, box_x, box_y, box_size, blend_mode);
     }
+    bgt_destroy_layer(background);
 
     wait_continue("演示5：键盘事件和混合模式完成", 40, 40, 60);
 }
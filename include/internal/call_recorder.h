@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_stdinc.h>
+
+// ==========================================
+// CallRecorder (录制与回放 bgt_* 调用)
+// ==========================================
+// 文件格式：文件头 "BGTR" 加一个字节的版本号，之后是连续的调用记录。
+// 每条记录依次为：一个字节的 CallOp、距上一条记录的纳秒数、参数。
+// 整数使用 zigzag 编码的变长整数，字符串为长度加字节，像素为个数加原始的 32 位像素（小端）。
+// 字符串按原样保存，USE_ANSI 构建录制的文件需要用 USE_ANSI 构建的回放工具回放。
+// 编号写入文件，只能在末尾追加，不能修改已有的值。
+enum class CallOp : Uint8 {
+  Init = 1,
+  InitHeadless,
+  Quit,
+  Cls,
+  Rectangle,
+  Line,
+  Circle,
+  CircleOutline,
+  Ellipse,
+  EllipseOutline,
+  SetBlendMode,
+  Rectangles,
+  Lines,
+  Points,
+  Circles,
+  ShowStr,
+  MeasureText,
+  Flush,
+  SetFrameRate,
+  Delay,
+  BeginBatch,
+  EndBatch,
+  SetTextCacheBudget,
+  PixelsFillRect,
+  PixelsBlit,
+  UnlockPixels,
+  // 以下五项为输入，只用于了解程序当时收到了什么；
+  // 回放时只重现 InputNumber/InputAscii 结束时对画布的修改（用背景色擦除输入区域）
+  Getch,
+  ReadKeyboardAndMouse,
+  ReadEvents,
+  InputNumber,
+  InputAscii,
+  // 图层
+  CreateLayer,
+  DestroyLayer,
+  SetDrawLayer,
+  ClearLayer,
+  CompositeLayer,
+  // 图片
+  LoadImage,
+  FreeImage,
+  DrawImages,
+  SetImageAtlasSize,
+  LockPixels,
+};
+
+class CallWriter {
+public:
+  ~CallWriter() { close(); }
+
+  bool open(const char *utf8Path);
+  bool close();
+  bool isOpen() const { return m_io != nullptr; }
+
+  void beginCall(CallOp op);
+  void putInt(Sint64 value);
+  void putInts(std::initializer_list<int> values);
+  void putUint(Uint64 value);
+  void putString(std::string_view str);
+  // 写出 height 行、每行 width 个像素；pitch 为源数据每行的像素数
+  void putPixels(const Uint32 *pixels, int pitch, int width, int height);
+
+private:
+  bool flushBuffer();
+
+  SDL_IOStream *m_io = nullptr;
+  std::vector<Uint8> m_buffer;
+  Uint64 m_lastNs = 0;
+  bool m_failed = false;
+};
+
+class CallReader {
+public:
+  // 整个文件读入内存，回放时不受磁盘速度影响
+  bool open(const char *utf8Path);
+
+  // 读到文件末尾或者格式错误时返回 false，用 failed 区分两者
+  bool next(CallOp &op, Uint64 &deltaNs);
+  bool failed() const { return m_failed; }
+  // 回到第一条记录，用于多次回放
+  void rewind();
+
+  Sint64 getInt();
+  Uint64 getUint();
+  std::string getString();
+  // 读出 count 个像素，不足时返回空
+  std::vector<Uint32> getPixels(std::size_t count);
+
+private:
+  std::vector<Uint8> m_data;
+  std::size_t m_pos = 0;
+  bool m_failed = false;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include <SDL3/SDL_rect.h>
+
+// ==========================================
+// DirtyRegion (记录自上次显示以来被修改过的区域)
+// ==========================================
+// 维护一个短小的矩形列表：相交或相邻的矩形会被合并，
+// 数量超过上限或者总面积接近整个画布时，退化为“整个画布都脏了”。
+class DirtyRegion {
+public:
+  static constexpr std::size_t kMaxRects = 16;
+
+  void setBounds(int w, int h);
+
+  // 记录一块被修改的区域，会先裁剪到画布范围内
+  void add(SDL_Rect rect);
+  void markAll() { m_full = true; }
+  void clear();
+
+  bool empty() const { return !m_full && m_rects.empty(); }
+  bool isFull() const { return m_full; }
+  std::span<const SDL_Rect> rects() const { return m_rects; }
+
+private:
+  void collapse();
+
+  int m_width = 0;
+  int m_height = 0;
+  bool m_full = false;
+  std::vector<SDL_Rect> m_rects;
+};
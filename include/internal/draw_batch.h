@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <SDL3/SDL_pixels.h>
+#include <SDL3/SDL_rect.h>
+#include <SDL3/SDL_render.h>
+
+// ==========================================
+// DrawBatch (批量绘制的命令缓冲区)
+// ==========================================
+// bgt_begin_batch 与 bgt_end_batch 之间的绘制调用不会立即执行，而是记录在这里，
+// 提交时按记录顺序回放。相邻且颜色相同的矩形（包括圆形拆出来的扫描线）会被合并，
+// 最终只对应一次 SDL_RenderFillRects 调用。
+class DrawBatch {
+public:
+  // 文本的实际绘制由调用者提供，以便复用 bgt_show_str 的渲染路径
+  using TextDrawer = bool (*)(float x, float y, const char *utf8,
+                              SDL_Color color);
+
+  void addRects(SDL_Color color, std::span<const SDL_FRect> rects);
+  void addLine(SDL_Color color, float x1, float y1, float x2, float y2);
+  void addText(SDL_Color color, float x, float y, std::string_view utf8);
+  void addClear(SDL_Color color);
+  void addBlendMode(SDL_BlendMode mode);
+  // 带顶点颜色的三角形，indices 相对于 vertices 的起点；texture 为空时不贴图。
+  // 与上一条使用同一纹理的几何命令相邻时会合并为一次 SDL_RenderGeometry。
+  // 带纹理的命令在提交时使用当时的 DrawBlendMode，与其他绘制保持一致
+  void addGeometry(std::span<const SDL_Vertex> vertices,
+                   std::span<const int> indices,
+                   SDL_Texture *texture = nullptr);
+
+  bool empty() const { return m_commands.empty(); }
+  std::size_t commandCount() const { return m_commands.size(); }
+
+  /**
+   * @brief 按记录顺序提交所有命令，并清空缓冲区
+   *
+   * 调用者负责事先设置好渲染目标，并在之后恢复 DrawColor
+   */
+  bool submit(SDL_Renderer *renderer, TextDrawer drawText);
+
+  void clear();
+
+private:
+  enum class Kind { FillRects, Line, Text, Clear, BlendMode, Geometry };
+
+  struct Command {
+    Kind kind;
+    SDL_Color color;
+    SDL_BlendMode blendMode;
+    // Line 的两个端点；Text 只使用 (x1, y1)
+    float x1, y1, x2, y2;
+    // FillRects: m_rects 中的区间；Text: m_text 中的起始偏移；
+    // Geometry: m_vertices 中的区间
+    std::size_t first, count;
+    // Geometry: m_indices 中的区间与纹理
+    std::size_t indexFirst, indexCount;
+    SDL_Texture *texture;
+  };
+
+  std::vector<Command> m_commands;
+  std::vector<SDL_FRect> m_rects;
+  std::vector<SDL_Vertex> m_vertices;
+  std::vector<int> m_indices;
+  // 所有文本首尾相接存放，每段以 '\0' 结尾
+  std::string m_text;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <SDL3_ttf/SDL_ttf.h>
+
+class GlyphAtlas;
+
+// ==========================================
+// FontMetrics (字体度量与字符串宽度的缓存)
+// ==========================================
+// 字体在 bgt_init 之后不会再变化，因此常用的度量只需计算一次。
+// 字符串宽度的测量：
+//   - 等宽字体直接累加图集中缓存的逐字符宽度，既不排版也不分配内存；
+//   - 其他字体需要考虑字距调整，只能交给 TTF_MeasureString，但会记住测过的字符串，
+//     查找时使用 std::string_view，命中时不会分配内存。
+class FontMetrics {
+public:
+  static constexpr std::size_t kMaxMemoEntries = 4096;
+
+  void init(TTF_Font *font, GlyphAtlas *atlas);
+  void reset();
+
+  int spaceWidth() const { return m_spaceWidth; }
+  int height() const { return m_height; }
+
+  int measure(std::string_view utf8);
+
+private:
+  struct StringHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view s) const {
+      return std::hash<std::string_view>{}(s);
+    }
+  };
+
+  TTF_Font *m_font = nullptr;
+  GlyphAtlas *m_atlas = nullptr;
+  int m_spaceWidth = 0;
+  int m_height = 0;
+  std::unordered_map<std::string, int, StringHash, std::equal_to<>> m_memo;
+};
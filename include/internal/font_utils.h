@@ -1,4 +1,5 @@
 #include <cassert>
+#include <cstdint>
 #include <filesystem>
 #include <memory>
 #include <string>
@@ -90,6 +91,10 @@ private:
 // ==========================================
 // 3. FontManager (核心逻辑：匹配与排序)
 // ==========================================
+// 扫描系统中的全部字体（FcConfigBuildFonts）在字体很多的机器上要花费很长时间，
+// 因此 resolve 的结果按查询条件缓存在用户数据目录（SDL_GetPrefPath）下。
+// 缓存带有 fontconfig 缓存目录与字体目录的修改时间，安装或卸载字体后自动失效；
+// 缓存中的文件不存在时也视为失效。命中缓存时完全不需要扫描字体。
 class FontManager {
 public:
   FontManager();
@@ -111,6 +116,11 @@ public:
 
 private:
   FontSetPtr internal_resolve(const FontQuery &query) const;
+  // 扫描系统字体，只在真正需要匹配字体时调用一次
+  FcConfig *fonts() const;
+  // 由 fontconfig 缓存目录与字体目录的修改时间算出的标记，字体变化后随之改变
+  std::uint64_t cacheStamp() const;
 
   ConfigPtr m_config;
+  mutable bool m_fontsBuilt = false;
 };
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include <SDL3/SDL_stdinc.h>
+
+// ==========================================
+// FrameProfiler (统计每一帧的时间都花在了哪里)
+// ==========================================
+// 两次刷新之间算作一帧。各个热点路径用 Scope 计时，嵌套的 Scope 会暂停外层的计时，
+// 因此各部分的时间互不重叠：例如绘制函数内部触发的刷新只计入 Present，不计入 Draw。
+// 默认不启用：此时 Scope 与 countDrawCall 不读取时钟、不做任何事，热点路径上没有额外开销。
+class FrameProfiler {
+public:
+  enum Zone { Draw, Text, TextShaping, Present, Events, kZoneCount };
+  static constexpr std::size_t kHistorySize = 120;
+
+  struct Frame {
+    double frameMs = 0;
+    std::array<double, kZoneCount> zoneMs{};
+    unsigned long long drawCalls = 0;
+    unsigned long long pixels = 0;
+    unsigned long long cacheHits = 0;
+    unsigned long long cacheMisses = 0;
+  };
+
+  class Scope {
+  public:
+    Scope(FrameProfiler &profiler, Zone zone)
+        : m_profiler(profiler), m_outer(profiler.m_active),
+          m_entered(profiler.m_enabled) {
+      if (m_entered)
+        m_profiler.enter(zone);
+    }
+    ~Scope() {
+      if (m_entered)
+        m_profiler.leave(m_outer);
+    }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    FrameProfiler &m_profiler;
+    int m_outer;
+    bool m_entered;
+  };
+
+  // 启用或停用统计；状态改变时清空已有的统计数据
+  void setEnabled(bool enabled);
+  bool enabled() const { return m_enabled; }
+
+  void countDrawCall() {
+    if (m_enabled)
+      m_drawCalls++;
+  }
+
+  // 刚才在当前计时区间里花掉的 ticks 其实属于 zone，例如文本缓存未命中时的排版
+  void moveToZone(Zone zone, Uint64 ticks);
+
+  // 一帧结束时调用；pixelsTotal、cacheHits、cacheMisses 为累计值，由此求出本帧的增量
+  void endFrame(unsigned long long pixelsTotal, unsigned long long cacheHits,
+                unsigned long long cacheMisses);
+  // 重新记录累计值的基准，之后的增量计入下一帧（用于排除性能浮层自身的文字绘制）
+  void rebase(unsigned long long pixelsTotal, unsigned long long cacheHits,
+              unsigned long long cacheMisses);
+  // 清空统计数据，保留启用状态
+  void reset();
+
+  const Frame &lastFrame() const { return m_last; }
+  // 最近一秒内的平均帧率
+  double fps() const;
+  // 最近 kHistorySize 帧的时长（毫秒），index 0 为最早的一帧
+  std::size_t historySize() const { return m_historyCount; }
+  float historyAt(std::size_t index) const;
+
+private:
+  void enter(Zone zone);
+  void leave(int outer);
+  void accumulateActive(Uint64 now);
+
+  bool m_enabled = false;
+  std::array<Uint64, kZoneCount> m_ticks{};
+  int m_active = -1;
+  Uint64 m_activeStart = 0;
+  unsigned long long m_drawCalls = 0;
+  Uint64 m_frameStartNs = 0;
+
+  unsigned long long m_pixelsBase = 0;
+  unsigned long long m_hitsBase = 0;
+  unsigned long long m_missesBase = 0;
+
+  Frame m_last;
+  std::array<float, kHistorySize> m_history{};
+  std::size_t m_historyNext = 0;
+  std::size_t m_historyCount = 0;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <SDL3/SDL_render.h>
+#include <SDL3_ttf/SDL_ttf.h>
+
+// ==========================================
+// GlyphAtlas (等宽字体的字形图集)
+// ==========================================
+// 对等宽字体而言，排版只是把字形一个接一个地摆放，不需要 HarfBuzz 参与。
+// 这里把字形预先光栅化到少量大纹理上，绘制字符串时直接拼出带纹理的四边形，
+// 整个字符串只需一次 SDL_RenderGeometry。
+// 可打印 ASCII 字符在 init 时预先加载，其余字符（如汉字）在第一次用到时加入图集。
+class GlyphAtlas {
+public:
+  static constexpr int kPageSize = 1024;
+
+  GlyphAtlas() = default;
+  GlyphAtlas(const GlyphAtlas &) = delete;
+  GlyphAtlas &operator=(const GlyphAtlas &) = delete;
+  ~GlyphAtlas() { reset(); }
+
+  void init(SDL_Renderer *renderer, TTF_Font *font);
+  void reset();
+
+  bool enabled() const { return m_renderer != nullptr; }
+
+  /**
+   * @brief 测量字符串宽度
+   *
+   * @return 字符串中有图集无法处理的字符（控制字符、主字体缺失的字形）时返回 false，
+   *         调用者应当退回常规的排版路径
+   */
+  bool measure(std::string_view utf8, int *width);
+
+  // 在当前渲染目标上绘制，返回值含义同 measure
+  bool draw(std::string_view utf8, float x, float y, SDL_Color color);
+
+private:
+  struct Glyph {
+    bool loaded = false;
+    bool supported = false;
+    int page = 0;
+    SDL_FRect src{};
+    int advance = 0;
+  };
+
+  const Glyph &glyph(Uint32 codepoint);
+  Glyph rasterize(Uint32 codepoint);
+  bool allocate(int w, int h, int &page, int &x, int &y);
+
+  SDL_Renderer *m_renderer = nullptr;
+  TTF_Font *m_font = nullptr;
+  int m_lineHeight = 0;
+
+  // ASCII 字符直接查表，其余字符查哈希表
+  std::array<Glyph, 128> m_ascii{};
+  std::unordered_map<Uint32, Glyph> m_glyphs;
+
+  // 按行（shelf）分配图集空间，每行高度固定为字体高度
+  std::vector<SDL_Texture *> m_pages;
+  int m_penX = 0;
+  int m_penY = 0;
+
+  // 复用的顶点缓冲区，避免每次绘制都分配内存
+  std::vector<SDL_Vertex> m_vertices;
+  std::vector<int> m_indices;
+  std::vector<int> m_pageOfQuad;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <SDL3/SDL_rect.h>
+#include <SDL3/SDL_render.h>
+
+#include <internal/skyline_packer.h>
+
+// ==========================================
+// ImageCache (bgt_load_image 加载的图片)
+// ==========================================
+// 图片以纹理的形式保存，对外用从 1 开始的整数编号表示。
+// 同一个文件（按规范化后的路径判断）只加载一次，重复加载返回同一个编号并增加引用计数。
+// 小图片会被装进共用的图集纹理，相邻的精灵即使来自不同的图片也能一次提交。
+// 每张图片四周留出 kPadding 像素，填充为图片边缘的颜色，缩放时不会采样到相邻的图片。
+// 图集中的空间不单独回收，一张图集上的图片全部释放后整张图集才会释放。
+class ImageCache {
+public:
+  static constexpr int kDefaultAtlasSize = 1024;
+  static constexpr int kPadding = 1;
+
+  struct Image {
+    SDL_Texture *texture = nullptr;
+    // 图片在纹理中所占的区域（像素），计算纹理坐标时使用
+    SDL_FRect region{};
+    float textureWidth = 0, textureHeight = 0;
+    int width = 0, height = 0;
+  };
+
+  ImageCache() = default;
+  ImageCache(const ImageCache &) = delete;
+  ImageCache &operator=(const ImageCache &) = delete;
+  ~ImageCache() { clear(); }
+
+  // 图集的边长，只影响之后加载的图片；0 表示不使用图集，每张图片单独一个纹理
+  void setAtlasSize(int size) { m_atlasSize = size; }
+  int atlasSize() const { return m_atlasSize; }
+
+  // 失败返回 0，原因可通过 SDL_GetError 获取
+  int acquire(SDL_Renderer *renderer, const char *utf8Path);
+  // 引用计数归零时释放纹理，编号留给之后加载的图片复用
+  bool release(int handle);
+  // 编号无效时返回 nullptr
+  const Image *find(int handle) const;
+  void clear();
+
+private:
+  struct Entry {
+    Image image;
+    std::string key;
+    int refs = 0;
+    // 所在图集在 m_pages 中的下标，单独一个纹理时为 -1
+    int page = -1;
+  };
+
+  struct Page {
+    SDL_Texture *texture = nullptr;
+    SkylinePacker packer;
+    int size = 0;
+    // 图集上还在使用的图片数
+    int images = 0;
+  };
+
+  // 尝试把 surface 装进图集，成功时填写 entry 的纹理与区域
+  bool pack(SDL_Renderer *renderer, SDL_Surface *surface, Entry &entry);
+  // 返回新图集在 m_pages 中的下标，失败返回 -1
+  int addPage(SDL_Renderer *renderer, int size);
+
+  std::vector<Entry> m_entries;
+  std::vector<Page> m_pages;
+  int m_atlasSize = kDefaultAtlasSize;
+  std::unordered_map<std::string, int> m_handles;
+};
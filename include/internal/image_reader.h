@@ -0,0 +1,10 @@
+#pragma once
+
+#include <SDL3/SDL_surface.h>
+
+// ==========================================
+// 图像文件读取 (bgt_compare_frame)
+// ==========================================
+// 支持 bgt_save_frame 写出的 .png、.ppm（二进制 P6，最大值 255）与 .bmp 三种格式，
+// 返回 SDL_PIXELFORMAT_RGB24 格式的表面，由调用者用 SDL_DestroySurface 释放；失败返回 nullptr。
+SDL_Surface *loadImage(const char *utf8Path);
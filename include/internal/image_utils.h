@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstring>
+#include <memory>
+
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_surface.h>
+
+// ==========================================
+// 图像读写共用的小工具 (bgt_save_frame / bgt_compare_frame)
+// ==========================================
+// RAII 包装，保证任何错误路径上都会释放临时表面
+struct SurfaceDeleter {
+  void operator()(SDL_Surface *s) const {
+    if (s)
+      SDL_DestroySurface(s);
+  }
+};
+
+using SurfacePtr = std::unique_ptr<SDL_Surface, SurfaceDeleter>;
+
+// 判断文件名是否以 ext（如 ".png"）结尾，大小写不敏感
+inline bool hasExtension(const char *path, const char *ext) {
+  const std::size_t len = std::strlen(path), extLen = std::strlen(ext);
+  return len >= extLen && SDL_strcasecmp(path + len - extLen, ext) == 0;
+}
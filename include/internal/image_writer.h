@@ -0,0 +1,11 @@
+#pragma once
+
+#include <SDL3/SDL_surface.h>
+
+// ==========================================
+// 图像文件输出 (bgt_save_frame)
+// ==========================================
+// 根据扩展名选择格式：.png、.ppm（二进制 P6）或 .bmp，大小写不敏感。
+// 只保存 RGB 三个通道，与窗口上看到的内容一致。
+// PNG 由 SDL3_image 编码，BMP 由 SDL 写出，PPM 直接写出像素。
+bool saveImage(const char *utf8Path, SDL_Surface *surface);
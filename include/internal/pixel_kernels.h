@@ -0,0 +1,34 @@
+#pragma once
+
+#include <SDL3/SDL_blendmode.h>
+#include <SDL3/SDL_stdinc.h>
+
+// ==========================================
+// 像素混合内核 (bgt_lock_pixels 所得画布上的 CPU 绘制)
+// ==========================================
+// 像素格式为 RGBA8888，即 32 位整数从高到低依次为 R、G、B、A。
+// 混合公式与 SDL_BLENDMODE_* 的定义一致，x * y / 255 一律精确舍入到最近整数，
+// 结果超过 255 时饱和；因此各指令集版本的结果逐位相同。
+
+enum class PixelIsa { Scalar, SSE2, AVX2 };
+
+// 把一行 count 个像素与同一个颜色 color 混合
+using FillRowFn = void (*)(Uint32 *dst, int count, Uint32 color);
+// 把一行 count 个像素与 src 中对应的像素混合
+using BlitRowFn = void (*)(Uint32 *dst, const Uint32 *src, int count);
+
+struct PixelKernels {
+  FillRowFn fill;
+  BlitRowFn blit;
+};
+
+// 当前 CPU 支持的最快指令集，首次调用时检测
+PixelIsa bestPixelIsa();
+const char *pixelIsaName(PixelIsa isa);
+
+// 取得指定混合模式在指定指令集下的内核；模式无效或指令集不可用时返回 nullptr
+const PixelKernels *pixelKernels(SDL_BlendMode mode, PixelIsa isa);
+
+inline const PixelKernels *pixelKernels(SDL_BlendMode mode) {
+  return pixelKernels(mode, bestPixelIsa());
+}
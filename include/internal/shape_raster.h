@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vector>
+
+#include <SDL3/SDL_rect.h>
+
+// ==========================================
+// 椭圆（圆）的扫描线光栅化
+// ==========================================
+// 只用整数运算求出每一行的半宽，把图形拆成若干水平的矩形，
+// 整个图形只需一次 SDL_RenderFillRects。半宽取满足
+// x^2 * ry^2 + y^2 * rx^2 <= rx^2 * ry^2 的最大 x，
+// 对于圆而言与 floor(sqrt(r^2 - y^2)) 完全一致。
+
+// 填充椭圆：相邻且等宽的行会合并为一个矩形，结果追加到 out
+void appendEllipseSpans(int cx, int cy, int rx, int ry,
+                        std::vector<SDL_FRect> &out);
+
+// 椭圆轮廓：只包含填充区域中与外部相邻（4 连通）的像素，每个像素只出现一次
+void appendEllipseOutlineSpans(int cx, int cy, int rx, int ry,
+                               std::vector<SDL_FRect> &out);
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// ==========================================
+// SkylinePacker (把小矩形装进一张大纹理)
+// ==========================================
+// 记录已占用区域的上轮廓线（skyline），每个新矩形放在能让它的上边最低的位置，
+// 同样低时选更窄的一段轮廓，以减少留下的空隙。只支持放入，不支持单独取出某个矩形。
+class SkylinePacker {
+public:
+  void init(int width, int height);
+
+  // 放不下时返回 false
+  bool insert(int width, int height, int &x, int &y);
+
+private:
+  struct Segment {
+    int x, y, width;
+  };
+
+  // 以第 index 段轮廓为左端放入宽 width、高 height 的矩形时，矩形的 y；放不下时返回 -1
+  int fit(std::size_t index, int width, int height) const;
+  void place(std::size_t index, int x, int y, int width, int height);
+
+  int m_width = 0, m_height = 0;
+  std::vector<Segment> m_skyline;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <SDL3_ttf/SDL_ttf.h>
+
+// ==========================================
+// TextCache (已排版文本的 LRU 缓存)
+// ==========================================
+// TTF_CreateText 需要对字符串做完整的排版，代价远高于绘制本身。
+// 这里按 (字体, UTF-8 字节序列) 缓存排版好的 TTF_Text，颜色在绘制时再设置，
+// 因此同一段文字换颜色绘制也能命中缓存。
+class TextCache {
+public:
+  static constexpr std::size_t kDefaultBudget = 1024 * 1024;
+
+  TextCache() = default;
+  TextCache(const TextCache &) = delete;
+  TextCache &operator=(const TextCache &) = delete;
+  ~TextCache() { clear(); }
+
+  /**
+   * @brief 查找或创建一段文本
+   *
+   * 返回的 TTF_Text 归缓存所有，在下一次调用 acquire 之前保证有效
+   *
+   * @param width 若非空，返回文本的测量宽度（与 TTF_MeasureString 一致）
+   * @return 创建失败时返回 nullptr，原因可通过 SDL_GetError 获取
+   */
+  TTF_Text *acquire(TTF_TextEngine *engine, TTF_Font *font,
+                    std::string_view utf8, int *width);
+
+  // 设置内存预算（字节），超出时淘汰最久未使用的条目。内存占用是估算值
+  void setBudget(std::size_t bytes);
+
+  void clear();
+
+  unsigned long long hits() const { return m_hits; }
+  unsigned long long misses() const { return m_misses; }
+  std::size_t bytes() const { return m_bytes; }
+
+private:
+  struct Entry {
+    TTF_Font *font;
+    std::string utf8;
+    TTF_Text *text;
+    int width;
+    std::size_t cost;
+  };
+
+  // 索引的键直接引用链表节点中的字符串，查找时无需构造 std::string
+  struct KeyView {
+    TTF_Font *font;
+    std::string_view utf8;
+    bool operator==(const KeyView &) const = default;
+  };
+
+  struct KeyHash {
+    std::size_t operator()(const KeyView &key) const {
+      return std::hash<std::string_view>{}(key.utf8) ^
+             (std::hash<const void *>{}(key.font) << 1);
+    }
+  };
+
+  void evictUntil(std::size_t budget);
+
+  std::list<Entry> m_lru; // 表头为最近使用
+  std::unordered_map<KeyView, std::list<Entry>::iterator, KeyHash> m_index;
+  std::size_t m_budget = kDefaultBudget;
+  std::size_t m_bytes = 0;
+  unsigned long long m_hits = 0;
+  unsigned long long m_misses = 0;
+};
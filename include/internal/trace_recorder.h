@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_timer.h>
+
+// ==========================================
+// TraceRecorder (记录库内部活动，导出为 Chrome trace 格式)
+// ==========================================
+// 每个事件记录名称、分类、开始时间与持续时间，写入固定容量的环形缓冲区，写满后覆盖最早的事件。
+// 写入不加锁：每个槽位带一个序号，导出时序号前后不一致的槽位说明正在被改写，直接跳过。
+// 导出的 JSON 可以用 chrome://tracing 或 https://ui.perfetto.dev 打开。
+class TraceRecorder {
+public:
+  // 名称与分类必须是字符串字面量等生命周期足够长的字符串，缓冲区中只保存指针
+  class Scope {
+  public:
+    Scope(TraceRecorder &recorder, const char *name, const char *category)
+        : m_recorder(recorder), m_name(name), m_category(category),
+          m_start(recorder.enabled() ? SDL_GetPerformanceCounter() : 0) {}
+    ~Scope() {
+      if (m_start)
+        m_recorder.record(m_name, m_category, m_start,
+                          SDL_GetPerformanceCounter());
+    }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    TraceRecorder &m_recorder;
+    const char *m_name;
+    const char *m_category;
+    Uint64 m_start;
+  };
+
+  // capacity 向上取整为 2 的幂；重新开始会丢弃之前记录的事件
+  void start(std::size_t capacity);
+  void stop() { m_enabled.store(false, std::memory_order_relaxed); }
+  bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+  // start 与 end 为 SDL_GetPerformanceCounter 的读数
+  void record(const char *name, const char *category, Uint64 start, Uint64 end);
+
+  // 按开始时间排序后写出缓冲区中现有的事件，不影响继续记录
+  bool writeChromeTrace(const char *utf8Path) const;
+  void reset();
+
+private:
+  struct Slot {
+    std::atomic<Uint64> sequence{0};
+    const char *name = nullptr;
+    const char *category = nullptr;
+    Uint64 start = 0;
+    Uint64 end = 0;
+    Uint64 threadId = 0;
+  };
+
+  std::unique_ptr<Slot[]> m_slots;
+  std::size_t m_mask = 0;
+  std::atomic<Uint64> m_next{0};
+  std::atomic<bool> m_enabled{false};
+};
@@ -20,6 +20,20 @@
 #define MOUSE_WHEEL_MOVED_UP 0x0080            // 滚轮向上移动
 #define MOUSE_WHEEL_MOVED_DOWN 0x0100          // 滚轮向下移动
 
+/* 定义鼠标按键，用于 bgt_mouse_down 等函数 */
+#define BGT_MOUSE_LEFT 1
+#define BGT_MOUSE_MIDDLE 2
+#define BGT_MOUSE_RIGHT 3
+#define BGT_MOUSE_X1 4
+#define BGT_MOUSE_X2 5
+
+/* 把颜色分量组合成 bgt_lock_pixels 所用的像素值 */
+#define BGT_PIXEL(r, g, b, a) \
+	(((unsigned int)(r) << 24) | ((unsigned int)(g) << 16) | ((unsigned int)(b) << 8) | (unsigned int)(a))
+
+/* 图层编号，用于 bgt_set_draw_layer 选择画布本身 */
+#define BGT_CANVAS 0
+
 /* 定义Alpha通道不透明和透明值 */
 #define BGT_ALPHA_OPAQUE 255		// 完全不透明
 #define BGT_ALPHA_TRANSPARENT 0		// 完全透明
@@ -34,6 +48,76 @@
 #define BGT_BLENDMODE_MUL                   0x00000008u /**< color multiply: dstRGB = (srcRGB * dstRGB) + (dstRGB * (1-srcA)), dstA = dstA */
 #define BGT_BLENDMODE_INVALID               0x7FFFFFFFu
 
+/* 定义渲染器的常用取值，见 bgt_set_renderer */
+#define BGT_RENDERER_SOFTWARE "software"	// 软件渲染（默认）
+#define BGT_RENDERER_ACCELERATED ""			// 由 SDL 自动选择可用的硬件加速渲染器
+
+/* 定义帧率限制的特殊取值，见 bgt_set_frame_rate */
+#define BGT_FRAME_RATE_UNLIMITED 0		// 每次刷新请求都立即显示（默认）
+#define BGT_FRAME_RATE_ON_IDLE -1		// 只在程序等待输入或延时之前显示
+
+
+/**
+ * @brief 以无窗口模式初始化，用于在没有显示器的机器上批量生成图像或自动评测
+ *
+ * 不创建窗口，所有绘制函数照常工作，结果保存在内存中的画布上，可以用 bgt_save_frame 写入文件。
+ * 刷新不做任何事情，bgt_delay 立即返回。
+ * 等待输入的函数（bgt_getch、bgt_input_* 等）只会读取程序自己用 SDL_PushEvent 放入的事件，绝不阻塞：
+ * 事件耗尽时 bgt_getch 返回 0，bgt_input_* 视为按下了回车。
+ *
+ * 使用结束后同样调用 bgt_quit 释放资源。
+ *
+ * @param w, h 画布宽度与高度，单位为像素
+ * @param font_name, font_size 与 bgt_init 相同
+ * @return 成功返回true，失败返回false，失败原因可通过 bgt_get_error 获取
+ */
+bool bgt_init_headless(int w, int h, const char* font_name = "SimSun", int font_size = 20);
+
+/**
+ * @brief 把画布的当前内容保存为图像文件
+ *
+ * 格式由扩展名决定，支持 .png、.ppm 和 .bmp。保存的是画布本身，不需要先调用 bgt_flush。
+ *
+ * @param path 文件路径
+ * @return 成功返回true，失败返回false，失败原因可通过 bgt_get_error 获取
+ */
+bool bgt_save_frame(const char* path);
+
+/**
+ * @brief 把画布的当前内容与参考图像逐像素比较，用于自动评测或检查绘制结果是否发生变化
+ *
+ * 参考图像通常是先前用 bgt_save_frame 保存的 .png、.ppm 或 .bmp 文件。配合 bgt_init_headless 可以在没有显示器的机器上运行。
+ *
+ * @param path 参考图像路径，支持 .png、.ppm 和 .bmp
+ * @param tolerance 每个颜色分量允许的最大差值（0-255），0 表示要求完全一致
+ * @param mismatched_pixels 返回差异超出容差的像素个数
+ * @param diff_path 若不为 nullptr，则把差异图保存到这个路径：不一致的像素标为红色，其余像素变暗显示
+ * @return 比较顺利完成时返回 true（无论是否一致，结果见 mismatched_pixels）；
+ *         参考图像无法读取或尺寸与画布不同时返回 false，失败原因可通过 bgt_get_error 获取
+ */
+bool bgt_compare_frame(const char* path, int tolerance, int& mismatched_pixels, const char* diff_path = nullptr);
+
+/**
+ * @brief 选择 bgt_init 创建的渲染器，必须在 bgt_init 之前调用
+ *
+ * 默认使用软件渲染，绘制结果在所有机器上完全一致，适合初学者。
+ * 窗口很大（如 4K）时，可以改用硬件加速的渲染器以提升刷新速度。
+ * 绘制与刷新的行为不会改变：绘制函数依旧立即生效，bgt_flush 之后内容才显示在窗口上。
+ * 混合模式的计算公式相同，但显卡的舍入方式不同，颜色可能有 ±1 的差异。
+ *
+ * 若指定的渲染器不可用（例如没有显卡的远程桌面或 CI 环境），bgt_init 会自动退回软件渲染，
+ * 实际使用的渲染器可通过 bgt_get_renderer_name 查询。
+ *
+ * @param name BGT_RENDERER_SOFTWARE、BGT_RENDERER_ACCELERATED，
+ *             或者 SDL 渲染器的名称，如 "gpu"、"vulkan"、"opengl"、"direct3d11"，也可以是以逗号分隔的多个名称
+ * @return 成功返回true；在 bgt_init 之后调用时返回false，失败原因可通过 bgt_get_error 获取
+ */
+bool bgt_set_renderer(const char* name);
+
+/**
+ * @brief 获取当前实际使用的渲染器名称，如 "software"、"opengl"；尚未初始化时返回 nullptr
+ */
+const char* bgt_get_renderer_name();
 
 /**
  * @brief 初始化图形窗口
@@ -43,7 +127,7 @@
  * 注意，为了方便使用，强烈建议所有ASCII字符宽度相同、每个汉字均严格占用英文字符的两倍宽度的等宽字体。
  *
  * 使用高分屏时, 可以设置 fix_display_scale 为 true 以避免窗口过小,
- * 但由于我们使用的是软渲染, 若缩放倍数非整数倍, 则性能可能显著变差
+ * 但由于默认使用的是软渲染, 若缩放倍数非整数倍, 则性能可能显著变差（见 bgt_set_renderer）
  *
  * @param w, h 窗口宽度与高度，单位为像素
  * @param window_title 窗口标题
@@ -74,9 +158,152 @@ bool bgt_cls(int r = 0, int g = 0, int b = 0, bool flush=false);
 
 /**
  * @brief 刷新屏幕显示，将已绘制但未刷新的内容显示到窗口上
+ *
+ * 若通过 bgt_set_frame_rate 开启了帧率限制，则刷新请求会被合并，每个帧间隔内最多真正显示一次
  */
 bool bgt_flush();
 
+/**
+ * @brief 设置屏幕刷新的最高帧率
+ *
+ * 默认情况下，每次绘制函数的 flush 参数为 true 或调用 bgt_flush 时都会立即刷新屏幕，
+ * 短时间内大量绘制时，绝大部分时间都会花在刷新上。
+ * 设置帧率后，刷新请求会被合并，每个帧间隔内最多刷新一次。
+ *
+ * 无论如何设置，在 bgt_getch、bgt_delay、bgt_input_* 等需要等待的函数开始等待之前，
+ * 已经绘制的内容总是会被显示出来；bgt_read_keyboard_and_mouse 也会补上到期的刷新。
+ *
+ * @param fps 每秒最多刷新的次数；BGT_FRAME_RATE_UNLIMITED 表示不限制（默认），
+ *            BGT_FRAME_RATE_ON_IDLE 表示只在程序等待时才刷新
+ * @return 成功返回 true，失败返回 false，失败原因可通过 bgt_get_error 获取
+ */
+bool bgt_set_frame_rate(int fps);
+
+/**
+ * @brief 获取屏幕刷新的统计信息
+ *
+ * 刷新时只会把上次刷新以来绘制过的区域拷贝到窗口上，若什么都没有画则不会真正刷新。
+ *
+ * @param present_count 自 bgt_init 以来实际刷新窗口的次数
+ * @param pixels_pushed 自 bgt_init 以来从画布拷贝到窗口的像素总数
+ */
+void bgt_get_flush_stats(unsigned long long& present_count, unsigned long long& pixels_pushed);
+
+/**
+ * @brief 最近一帧的性能统计，见 bgt_get_frame_stats
+ *
+ * 两次刷新之间算作一帧。各项时间互不重叠，例如绘制函数内部触发的刷新只计入 present_ms。
+ */
+struct BGT_FrameStats {
+	double fps;					// 最近一秒内的平均帧率
+	double frame_ms;			// 这一帧的总时长，包括程序自身的计算与等待
+	double draw_ms;				// 绘制图形（包括批量模式的提交与直接像素访问）
+	double text_ms;				// 绘制文字，不含排版
+	double text_shaping_ms;		// 排版新的文字（文本缓存未命中），包括查找后备字体
+	double present_ms;			// 把画布刷新到窗口
+	double event_ms;			// 从系统收取事件
+	unsigned long long draw_calls;		// 绘制函数的调用次数
+	unsigned long long pixels_pushed;	// 从画布拷贝到窗口的像素数
+	double text_cache_hit_rate;			// 文本缓存命中率（0-1），这一帧没有用到缓存时为 1
+};
+
+/**
+ * @brief 启用或停用性能统计
+ *
+ * 统计默认关闭，此时绘制函数不做任何计时。启用后从下一帧开始统计，一直持续到停用或 bgt_quit。
+ * 停用时同时隐藏性能浮层。
+ *
+ * @param enable true 启用，false 停用并清空已有的统计
+ */
+void bgt_enable_profiler(bool enable);
+
+/**
+ * @brief 获取最近一帧的性能统计，用于找出程序慢在哪里
+ *
+ * 需要先用 bgt_enable_profiler 启用统计（bgt_show_profiler_overlay(true) 也会启用）。
+ * 没有启用时本函数会顺便启用统计，但这一次得到的各项均为 0。
+ */
+void bgt_get_frame_stats(BGT_FrameStats& stats);
+
+/**
+ * @brief 显示或隐藏性能浮层
+ *
+ * 浮层在每次刷新时绘制在窗口右上角，显示帧率、各部分耗时、绘制调用次数、拷贝的像素数、文本缓存命中率
+ * 以及最近若干帧的帧时长柱状图。浮层直接画在窗口上，不会改变画布的内容，也不会出现在 bgt_save_frame 保存的图像中。
+ */
+void bgt_show_profiler_overlay(bool show);
+
+/**
+ * @brief 开始记录库的活动，用于查找偶发的卡顿
+ *
+ * 开始后，每次调用 bgt_* 函数、提交批量绘制、刷新到窗口、加载字体以及排版新的文字，都会记录开始时间与耗时。
+ * 记录保存在内存中，超过 max_events 条后覆盖最早的记录。
+ * 调用 bgt_quit 或 bgt_stop_trace 时写入 path，也可以随时调用 bgt_save_trace 写出。
+ * 文件为 Chrome trace 格式的 JSON，可以用 chrome://tracing 或 https://ui.perfetto.dev 打开。
+ * 可以在 bgt_init 之前调用，以便记录初始化的过程。
+ *
+ * @param path 文件路径
+ * @param max_events 最多保留的记录条数
+ * @return 成功返回true，失败返回false，失败原因可通过 bgt_get_error 获取
+ */
+bool bgt_start_trace(const char* path, int max_events = 65536);
+
+/**
+ * @brief 立即写出目前的活动记录，之后继续记录
+ *
+ * @param path 文件路径，为 nullptr 时写入 bgt_start_trace 指定的文件
+ * @return 成功返回true，失败返回false，失败原因可通过 bgt_get_error 获取
+ */
+bool bgt_save_trace(const char* path = nullptr);
+
+/**
+ * @brief 停止记录，并把活动记录写入 bgt_start_trace 指定的文件
+ *
+ * @return 成功返回true，失败返回false，失败原因可通过 bgt_get_error 获取
+ */
+bool bgt_stop_trace();
+
+/**
+ * @brief 开始录制 bgt_* 调用，必须在 bgt_init 之前调用
+ *
+ * 每次绘制、刷新、测量文字等调用都会连同参数和时间写入 path，程序收到的键盘鼠标输入也一并记录。
+ * 录制的文件可以用 bgt_replay 工具在无窗口模式下尽快重新执行一遍，
+ * 不需要原来的程序就能复现同样的绘制负载，用来比较不同版本的库的性能。
+ * bgt_lock_pixels 期间写入的像素无法逐个记录，每次 bgt_unlock_pixels 会保存整个画布，文件可能因此变得很大。
+ *
+ * @param path 文件路径
+ * @return 成功返回true，失败返回false，失败原因可通过 bgt_get_error 获取
+ */
+bool bgt_start_recording(const char* path);
+
+/**
+ * @brief 停止录制并关闭文件；bgt_quit 会自动调用
+ *
+ * @return 成功返回true，写入文件时出错返回false，失败原因可通过 bgt_get_error 获取
+ */
+bool bgt_stop_recording();
+
+/**
+ * @brief 开始批量绘制
+ *
+ * 调用后，bgt_cls / bgt_rectangle / bgt_line / bgt_circle / bgt_ellipse（及其 _outline 版本）/ bgt_show_str、
+ * bgt_rectangles 等一次绘制多个图形的函数以及 bgt_set_blend_mode
+ * 不再立即绘制，而是被记录到命令缓冲区中；相邻且颜色相同的图形会被合并为一次提交。
+ * 批量模式期间，各绘制函数的 flush 参数不会立即刷新屏幕，而是推迟到 bgt_end_batch 时统一刷新一次。
+ *
+ * 在批量模式中调用 bgt_flush 会提交已记录的命令并刷新屏幕，适合在游戏循环中作为每一帧的结尾。
+ *
+ * 可以嵌套调用，只有最外层的 bgt_end_batch 才会真正提交
+ */
+void bgt_begin_batch();
+
+/**
+ * @brief 结束批量绘制，按记录顺序提交所有命令
+ *
+ * @return 成功返回 true，失败返回 false，失败原因可通过 bgt_get_error 获取
+ */
+bool bgt_end_batch();
+
 /**
  * @brief 绘制矩形
  *
@@ -115,6 +342,248 @@ bool bgt_line(int x1, int y1, int x2, int y2, int r, int g, int b,
 bool bgt_circle(int center_x, int center_y, int radius, int r, int g, int b,
 	int a = BGT_ALPHA_OPAQUE, bool flush = true);
 
+/**
+ * @brief 绘制圆形轮廓（1 像素宽）
+ *
+ * 轮廓恰好是 bgt_circle 所绘制的圆的最外一圈像素，每个像素只绘制一次，半透明时不会出现颜色叠加。
+ * 参数含义与 bgt_circle 相同
+ */
+bool bgt_circle_outline(int center_x, int center_y, int radius, int r, int g, int b,
+	int a = BGT_ALPHA_OPAQUE, bool flush = true);
+
+/**
+ * @brief 绘制椭圆（轴与坐标轴平行）
+ * @param center_x, center_y 椭圆中心坐标
+ * @param radius_x, radius_y 水平方向与竖直方向的半轴长度
+ * @param r, g, b 椭圆颜色RGB分量（0-255)
+ * @param a 椭圆颜色Alpha分量（0-255），默认不透明
+ * @param flush 是否立即刷新屏幕显示，默认立即刷新
+ * @return 成功返回true，失败返回false，失败原因可通过 bgt_get_error 获取
+ */
+bool bgt_ellipse(int center_x, int center_y, int radius_x, int radius_y, int r, int g, int b,
+	int a = BGT_ALPHA_OPAQUE, bool flush = true);
+
+/**
+ * @brief 绘制椭圆轮廓（1 像素宽），参数含义与 bgt_ellipse 相同
+ */
+bool bgt_ellipse_outline(int center_x, int center_y, int radius_x, int radius_y, int r, int g, int b,
+	int a = BGT_ALPHA_OPAQUE, bool flush = true);
+
+/**
+ * @brief 批量绘制函数使用的图形描述，颜色分量均为 0-255
+ */
+struct BGT_Rect {
+	int x, y, w, h;
+	unsigned char r, g, b, a;
+};
+
+struct BGT_Line {
+	int x1, y1, x2, y2;
+	unsigned char r, g, b, a;
+};
+
+struct BGT_Point {
+	int x, y;
+	unsigned char r, g, b, a;
+};
+
+struct BGT_Circle {
+	int center_x, center_y, radius;
+	unsigned char r, g, b, a;
+};
+
+/**
+ * @brief 一次绘制多个填充矩形
+ *
+ * 效果与对每个元素依次调用 bgt_rectangle(..., flush = false) 相同，但所有矩形只需一次提交，
+ * 即使颜色各不相同。适合热力图等需要绘制大量小方块的场景。
+ *
+ * @param rects 矩形数组
+ * @param count 数组长度
+ * @param flush 是否在全部绘制完成后刷新屏幕显示，默认刷新
+ * @return 成功返回true，失败返回false，失败原因可通过 bgt_get_error 获取
+ */
+bool bgt_rectangles(const BGT_Rect* rects, int count, bool flush = true);
+
+/**
+ * @brief 一次绘制多条直线，相当于依次调用 bgt_line，参数含义与 bgt_rectangles 相同
+ */
+bool bgt_lines(const BGT_Line* lines, int count, bool flush = true);
+
+/**
+ * @brief 一次绘制多个点，颜色相同的相邻点会合并为一次提交，参数含义与 bgt_rectangles 相同
+ */
+bool bgt_points(const BGT_Point* points, int count, bool flush = true);
+
+/**
+ * @brief 一次绘制多个实心圆，颜色相同的相邻圆会合并为一次提交，参数含义与 bgt_rectangles 相同
+ */
+bool bgt_circles(const BGT_Circle* circles, int count, bool flush = true);
+
+/**
+ * @brief 锁定画布，以便直接读写每一个像素
+ *
+ * 返回的缓冲区中保存着画布当前的内容，第 y 行第 x 列的像素是 pixels[y * pitch + x]，
+ * 每个像素是一个 32 位整数，从高位到低位依次为 R、G、B、A 分量，可以用 BGT_PIXEL 宏构造。
+ * 修改完成后必须调用 bgt_unlock_pixels，修改才会出现在画布上。
+ *
+ * 若自上次解锁以来没有调用其他绘制函数，加锁不需要从画布读回像素，开销很小，
+ * 因此逐帧绘制分形、元胞自动机等场景可以每帧加锁、修改、解锁。
+ * 锁定期间不要调用其他绘制函数，它们的结果会在解锁时被覆盖。
+ *
+ * @param pitch 返回缓冲区每一行的像素数（可能大于画布宽度）
+ * @return 成功返回像素缓冲区，失败返回 nullptr，失败原因可通过 bgt_get_error 获取
+ */
+unsigned int* bgt_lock_pixels(int& pitch);
+
+/**
+ * @brief 解锁画布，把 bgt_lock_pixels 返回的缓冲区中的像素原样写回画布（不做透明度混合）
+ *
+ * @param flush 是否立即刷新屏幕显示，默认立即刷新
+ * @return 成功返回true，失败返回false，失败原因可通过 bgt_get_error 获取
+ */
+bool bgt_unlock_pixels(bool flush = true);
+
+/**
+ * @brief 在 bgt_lock_pixels 锁定的画布上填充矩形，按当前的混合模式（见 bgt_set_blend_mode）与原有像素混合
+ *
+ * 与 bgt_rectangle 效果相同，但直接在内存中完成，并会根据 CPU 自动选用 SSE2 / AVX2 指令加速，
+ * 适合大面积的半透明叠加。超出画布的部分会被裁剪掉。
+ * 两者除以 255 的取整方式不同：渲染器逐项截断，这里精确舍入，半透明混合时每个颜色通道的结果最多相差 2。
+ *
+ * @return 成功返回true；画布未锁定或混合模式不受支持时返回false，失败原因可通过 bgt_get_error 获取
+ */
+bool bgt_pixels_fill_rect(int x, int y, int w, int h, int r, int g, int b, int a = BGT_ALPHA_OPAQUE);
+
+/**
+ * @brief 把一块像素按当前的混合模式绘制到 bgt_lock_pixels 锁定的画布上
+ *
+ * 与 bgt_pixels_fill_rect 一样，半透明混合的结果与渲染器绘制相比每个颜色通道最多相差 2。
+ *
+ * @param src 源像素，格式与 bgt_lock_pixels 返回的缓冲区相同
+ * @param src_pitch 源像素每一行的像素数
+ * @param x, y 绘制到画布上的位置
+ * @param w, h 源像素的宽度与高度，超出画布的部分会被裁剪掉
+ * @return 与 bgt_pixels_fill_rect 相同
+ */
+bool bgt_pixels_blit(const unsigned int* src, int src_pitch, int x, int y, int w, int h);
+
+/**
+ * @brief 加载图片，支持 PNG、BMP、JPG 等常见格式
+ *
+ * 同一个文件只加载一次：重复加载返回同一个编号，需要调用同样次数的 bgt_free_image 才会真正释放。
+ * 小图片会被装进共用的图集，见 bgt_set_image_atlas_size。
+ * 缩放绘制时使用纹理的默认过滤方式（线性插值），图集中的图片与单独的纹理效果相同。
+ * 必须在 bgt_init 之后调用，bgt_quit 时会释放所有图片。
+ *
+ * @param path 图片路径
+ * @return 图片编号（大于 0），失败返回 0，失败原因可通过 bgt_get_error 获取
+ */
+int bgt_load_image(const char* path);
+
+/**
+ * @brief 设置图集的边长，只影响之后加载的图片
+ *
+ * 边长不超过图集一半的小图片会被自动装进几张共用的大纹理（图集）中，绘制时透明地换算为图集中的位置。
+ * 这样即使场景中有上百种不同的小精灵，相邻的绘制也来自同一张纹理，可以合并为少数几次提交。
+ * 默认边长为 1024，超过显卡支持的最大纹理尺寸时按最大尺寸处理。
+ *
+ * @param size 图集的边长（像素），0 表示不使用图集，每张图片单独一个纹理
+ * @return 成功返回true，失败返回false，失败原因可通过 bgt_get_error 获取
+ */
+bool bgt_set_image_atlas_size(int size);
+
+/**
+ * @brief 释放 bgt_load_image 加载的图片
+ */
+bool bgt_free_image(int image);
+
+/**
+ * @brief 获取图片的宽度与高度，单位为像素
+ */
+bool bgt_get_image_size(int image, int& w, int& h);
+
+/**
+ * @brief 描述一次图片绘制，用于 bgt_draw_images
+ *
+ * 源矩形选出图片的一部分，用于从精灵表（多个小图拼成的一张大图）中取出一帧；
+ * 目标矩形的大小与源矩形不同时会缩放。r、g、b、a 与图片的颜色相乘，全部为 255 时按原样绘制。
+ */
+struct BGT_Sprite {
+	int image;
+	int src_x, src_y, src_w, src_h;	// 源矩形，src_w 或 src_h 不大于 0 时使用整张图片
+	int x, y, w, h;					// 目标矩形，w 或 h 不大于 0 时使用源矩形的大小
+	unsigned char r, g, b, a;
+};
+
+/**
+ * @brief 绘制整张图片
+ *
+ * @param image 图片编号
+ * @param x, y 左上角的位置
+ * @param w, h 绘制的大小，不大于 0 时使用图片原本的大小
+ * @param alpha 整体透明度（0-255）
+ * @param flush 是否立即刷新屏幕
+ */
+bool bgt_draw_image(int image, int x, int y, int w = 0, int h = 0, int alpha = BGT_ALPHA_OPAQUE, bool flush = true);
+
+/**
+ * @brief 一次绘制多个图片，参数含义与 bgt_rectangles 相同
+ *
+ * 使用同一张图片的相邻元素合并为一次提交，由上千个图块组成的地图也只需一次提交。
+ * 遇到无效的图片编号时跳过该元素，绘制其余元素后返回 false。
+ */
+bool bgt_draw_images(const BGT_Sprite* sprites, int count, bool flush = true);
+
+/**
+ * @brief 创建一个离屏图层
+ *
+ * 图层是一块独立的画布，初始为全透明。用 bgt_set_draw_layer 选中之后，所有绘图函数都画在图层上，
+ * 画好后用 bgt_composite_layer 一次性合成到画布上。网格、坐标轴、背景等不变的内容只需画一次，之后每帧合成即可。
+ *
+ * @param w, h 图层的大小，不大于 0 时与画布相同
+ * @return 图层编号（大于 0），失败返回 0，失败原因可通过 bgt_get_error 获取
+ */
+int bgt_create_layer(int w = 0, int h = 0);
+
+/**
+ * @brief 销毁图层；如果它正被选中，之后的绘制回到画布上
+ */
+bool bgt_destroy_layer(int layer);
+
+/**
+ * @brief 选择之后的绘图函数画在哪里
+ *
+ * 图层上的绘制不会直接出现在窗口上，刷新只显示画布。直接访问像素（bgt_lock_pixels）只能用于画布。
+ *
+ * @param layer bgt_create_layer 返回的图层编号，或者 BGT_CANVAS 表示画布本身
+ */
+bool bgt_set_draw_layer(int layer);
+
+/**
+ * @brief 获取当前选中的图层编号，BGT_CANVAS 表示画布本身
+ */
+int bgt_get_draw_layer();
+
+/**
+ * @brief 把图层清空为全透明（bgt_cls 会用不透明的颜色填满图层）
+ */
+bool bgt_clear_layer(int layer);
+
+/**
+ * @brief 把图层整体绘制到当前选中的画布或图层上
+ *
+ * 图层保存的是预乘 alpha 的颜色，因此默认使用 BGT_BLENDMODE_BLEND_PREMULTIPLIED 合成，效果与直接画在画布上相同。
+ *
+ * @param layer 图层编号，不能是当前选中的图层
+ * @param x, y 图层左上角在目标上的位置
+ * @param alpha 整体透明度（0-255），用于淡入淡出
+ * @param mode BGT_BLENDMODE_* 系列宏之一
+ * @param flush 是否立即刷新屏幕
+ */
+bool bgt_composite_layer(int layer, int x = 0, int y = 0, int alpha = BGT_ALPHA_OPAQUE,
+	unsigned int mode = BGT_BLENDMODE_BLEND_PREMULTIPLIED, bool flush = true);
+
 /**
 * @brief 非阻塞读取键盘和鼠标输入事件
 *
@@ -130,6 +599,80 @@ bool bgt_circle(int center_x, int center_y, int radius, int r, int g, int b,
 int bgt_read_keyboard_and_mouse(int& mouse_x, int& mouse_y, int& mouse_action,
 	int& keycode, int& key_modifier);
 
+/**
+* @brief 一个键盘或鼠标事件，字段含义与 bgt_read_keyboard_and_mouse 的参数相同
+*/
+struct BGT_Event {
+	int type;			// BGT_MOUSE_EVENT 或 BGT_KEYBOARD_EVENT
+	int mouse_x;
+	int mouse_y;
+	int mouse_action;	// MOUSE_* 系列宏定义之一，键盘事件为 MOUSE_NO_ACTION
+	int keycode;		// 键盘事件的按键码，使用 BGTK_* 系列宏定义判断
+	int key_modifier;
+};
+
+/**
+* @brief 非阻塞地一次读取所有待处理的键盘和鼠标事件
+*
+* 与 bgt_read_keyboard_and_mouse 每次只返回一个事件不同，本函数把当前积累的事件按顺序全部读入 events 数组，
+* 相邻的多个鼠标移动事件会被合并为一个，只保留最新位置。适合在游戏循环的每一帧开头调用，避免输入越积越多。
+*
+* @param events 调用者提供的数组，用于存放读到的事件
+* @param max_events 数组的大小；事件多于此数时，剩余的事件留到下一次读取
+* @return 实际读到的事件个数，没有事件时返回 0
+*/
+int bgt_read_events(BGT_Event* events, int max_events);
+
+/**
+* @brief 采样当前的键盘与鼠标状态，应当在游戏循环的每一帧开头调用一次
+*
+* 与 bgt_read_keyboard_and_mouse 不同，本函数不会从队列中取走任何事件，
+* 因此可以与 bgt_getch、bgt_input_* 等函数混合使用。
+* 采样之后，bgt_key_down / bgt_key_pressed / bgt_mouse_down 等查询函数都只是查表，开销可以忽略。
+*
+* 注意：“刚按下”与“刚松开”是通过比较相邻两次采样得到的，在两次采样之间按下又松开的按键不会被察觉。
+*/
+bool bgt_update_input_state();
+
+/**
+* @brief 最近一次采样时，指定按键是否处于按下状态
+*
+* @param keycode 按键码，使用 BGTK_* 系列宏定义
+*/
+bool bgt_key_down(int keycode);
+
+/**
+* @brief 指定按键是否在最近两次采样之间被按下（上次未按下，这次按下）
+*/
+bool bgt_key_pressed(int keycode);
+
+/**
+* @brief 指定按键是否在最近两次采样之间被松开（上次按下，这次未按下）
+*/
+bool bgt_key_released(int keycode);
+
+/**
+* @brief 最近一次采样时，指定鼠标按键是否处于按下状态
+*
+* @param button BGT_MOUSE_LEFT / BGT_MOUSE_MIDDLE / BGT_MOUSE_RIGHT / BGT_MOUSE_X1 / BGT_MOUSE_X2 之一
+*/
+bool bgt_mouse_down(int button);
+
+/**
+* @brief 指定鼠标按键是否在最近两次采样之间被按下
+*/
+bool bgt_mouse_pressed(int button);
+
+/**
+* @brief 指定鼠标按键是否在最近两次采样之间被松开
+*/
+bool bgt_mouse_released(int button);
+
+/**
+* @brief 获取最近一次采样时鼠标的位置，坐标与绘图使用的坐标系一致
+*/
+void bgt_get_mouse_position(int& mouse_x, int& mouse_y);
+
 /**
 * @brief 从键盘阻塞读取一个按键
 *
@@ -183,6 +726,19 @@ int bgt_input_ascii(int x, int y, char* buf, int max_len, int fg_r, int fg_g, in
 int bgt_show_str(int x, int y, const char* str, int r, int g, int b,
 	int a = BGT_ALPHA_OPAQUE, bool flush = true);
 
+/**
+* @brief 设置文本缓存的内存预算，单位为字节
+*
+* bgt_show_str 会缓存排版好的字符串（与颜色无关），反复绘制相同的文字时无需重新排版。
+* 缓存按最近最少使用的顺序淘汰，占用的内存是估算值。默认预算为 1 MiB，设为 0 相当于关闭缓存。
+*/
+void bgt_set_text_cache_budget(unsigned long long bytes);
+
+/**
+* @brief 获取文本缓存的命中与未命中次数，可用于判断缓存预算是否合适
+*/
+void bgt_get_text_cache_stats(unsigned long long& hits, unsigned long long& misses);
+
 /**
 * @brief 使用类似 cout 的方式格式化输出
 *
@@ -212,6 +768,8 @@ int bgt_get_font_width();
 
 /**
 * @brief 获取当前字体的高度，单位为像素
+*
+* 字体度量在 bgt_init 时计算并缓存，反复调用 bgt_get_font_width / bgt_get_font_height 没有额外开销
 */
 int bgt_get_font_height();
 
@@ -223,6 +781,13 @@ int bgt_get_font_height();
 */
 int bgt_measure_text(const char* str);
 
+/**
+* @brief 测量字符串前 len 个字节的显示宽度，单位为像素
+*
+* 与 bgt_measure_text(str) 相同，但不要求字符串以 '\0' 结尾，适合测量一个长字符串的前缀
+*/
+int bgt_measure_text(const char* str, int len);
+
 /**
 * @brief 设置色彩混合模式
 *
@@ -250,6 +815,8 @@ bool bgt_set_blend_mode(unsigned int mode);
 *
 * 效果类似于 Windows 的 Sleep，但不会卡死窗口导致无响应
 *
+* 等待期间只在有输入到来时才会醒来，并且会精确地在指定时间返回，适合用 bgt_delay(16) 之类的方式控制动画节奏
+*
 * 在初学阶段，可以使用延时来达成动画效果
 */
 void bgt_delay(int ms);
@@ -0,0 +1,180 @@
+#include <internal/call_recorder.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_timer.h>
+
+namespace {
+constexpr char kMagic[4] = {'B', 'G', 'T', 'R'};
+constexpr Uint8 kVersion = 2;
+// 缓冲区超过这个大小就写入文件，避免每次调用都进行一次系统调用
+constexpr std::size_t kFlushThreshold = 64 * 1024;
+
+Uint64 zigzag(Sint64 value) {
+  return (static_cast<Uint64>(value) << 1) ^ static_cast<Uint64>(value >> 63);
+}
+
+Sint64 unzigzag(Uint64 value) {
+  return static_cast<Sint64>(value >> 1) ^ -static_cast<Sint64>(value & 1);
+}
+} // namespace
+
+bool CallWriter::open(const char *utf8Path) {
+  close();
+  m_io = SDL_IOFromFile(utf8Path, "wb");
+  if (!m_io)
+    return false;
+  m_buffer.assign(kMagic, kMagic + sizeof(kMagic));
+  m_buffer.push_back(kVersion);
+  m_lastNs = SDL_GetTicksNS();
+  m_failed = false;
+  return true;
+}
+
+bool CallWriter::close() {
+  if (!m_io)
+    return true;
+  const bool flushed = flushBuffer();
+  const bool closed = SDL_CloseIO(m_io);
+  m_io = nullptr;
+  m_buffer.clear();
+  const bool ok = flushed && closed && !m_failed;
+  m_failed = false;
+  return ok;
+}
+
+bool CallWriter::flushBuffer() {
+  if (!m_buffer.empty() &&
+      SDL_WriteIO(m_io, m_buffer.data(), m_buffer.size()) != m_buffer.size())
+    m_failed = true;
+  m_buffer.clear();
+  return !m_failed;
+}
+
+void CallWriter::beginCall(CallOp op) {
+  if (m_buffer.size() >= kFlushThreshold)
+    flushBuffer();
+  const Uint64 now = SDL_GetTicksNS();
+  m_buffer.push_back(static_cast<Uint8>(op));
+  putUint(now - m_lastNs);
+  m_lastNs = now;
+}
+
+void CallWriter::putUint(Uint64 value) {
+  while (value >= 0x80) {
+    m_buffer.push_back(static_cast<Uint8>(value | 0x80));
+    value >>= 7;
+  }
+  m_buffer.push_back(static_cast<Uint8>(value));
+}
+
+void CallWriter::putInt(Sint64 value) { putUint(zigzag(value)); }
+
+void CallWriter::putInts(std::initializer_list<int> values) {
+  for (int value : values)
+    putInt(value);
+}
+
+void CallWriter::putString(std::string_view str) {
+  putUint(str.size());
+  m_buffer.insert(m_buffer.end(), str.begin(), str.end());
+}
+
+void CallWriter::putPixels(const Uint32 *pixels, int pitch, int width,
+                           int height) {
+  // 与其他字段一样按字节写出，录制文件在不同字节序的机器之间通用
+  m_buffer.reserve(m_buffer.size() +
+                   std::size_t(width) * height * sizeof(Uint32));
+  for (int y = 0; y < height; y++) {
+    const Uint32 *row = pixels + std::size_t(y) * pitch;
+    for (int x = 0; x < width; x++) {
+      const Uint32 pixel = row[x];
+      m_buffer.insert(m_buffer.end(),
+                      {static_cast<Uint8>(pixel), static_cast<Uint8>(pixel >> 8),
+                       static_cast<Uint8>(pixel >> 16),
+                       static_cast<Uint8>(pixel >> 24)});
+    }
+  }
+}
+
+bool CallReader::open(const char *utf8Path) {
+  m_data.clear();
+  m_pos = 0;
+  m_failed = false;
+  std::size_t size = 0;
+  void *data = SDL_LoadFile(utf8Path, &size);
+  if (!data)
+    return false;
+  const auto *bytes = static_cast<const Uint8 *>(data);
+  m_data.assign(bytes, bytes + size);
+  SDL_free(data);
+
+  if (size < sizeof(kMagic) + 1 ||
+      std::memcmp(m_data.data(), kMagic, sizeof(kMagic)) != 0)
+    return SDL_SetError("%s is not a libbgt recording", utf8Path);
+  if (m_data[sizeof(kMagic)] != kVersion)
+    return SDL_SetError("Unsupported recording version %d",
+                        m_data[sizeof(kMagic)]);
+  m_pos = sizeof(kMagic) + 1;
+  return true;
+}
+
+bool CallReader::next(CallOp &op, Uint64 &deltaNs) {
+  if (m_failed || m_pos >= m_data.size())
+    return false;
+  op = static_cast<CallOp>(m_data[m_pos++]);
+  deltaNs = getUint();
+  return !m_failed;
+}
+
+void CallReader::rewind() {
+  m_pos = std::min(m_data.size(), sizeof(kMagic) + 1);
+  m_failed = false;
+}
+
+Uint64 CallReader::getUint() {
+  Uint64 value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (m_pos >= m_data.size())
+      break;
+    const Uint8 byte = m_data[m_pos++];
+    value |= Uint64(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return value;
+  }
+  m_failed = true;
+  SDL_SetError("Truncated or corrupted recording");
+  return 0;
+}
+
+Sint64 CallReader::getInt() { return unzigzag(getUint()); }
+
+std::string CallReader::getString() {
+  const Uint64 size = getUint();
+  if (m_failed || size > m_data.size() - m_pos) {
+    m_failed = true;
+    SDL_SetError("Truncated or corrupted recording");
+    return {};
+  }
+  std::string str(reinterpret_cast<const char *>(m_data.data() + m_pos), size);
+  m_pos += size;
+  return str;
+}
+
+std::vector<Uint32> CallReader::getPixels(std::size_t count) {
+  if (m_failed || count > (m_data.size() - m_pos) / sizeof(Uint32)) {
+    m_failed = true;
+    SDL_SetError("Truncated or corrupted recording");
+    return {};
+  }
+  std::vector<Uint32> pixels(count);
+  for (auto &pixel : pixels) {
+    const Uint8 *bytes = m_data.data() + m_pos;
+    pixel = Uint32(bytes[0]) | Uint32(bytes[1]) << 8 | Uint32(bytes[2]) << 16 |
+            Uint32(bytes[3]) << 24;
+    m_pos += sizeof(Uint32);
+  }
+  return pixels;
+}
@@ -0,0 +1,82 @@
+#include <algorithm>
+
+#include <internal/dirty_region.h>
+
+namespace {
+// 两个矩形相交或者紧挨着，合并后不会引入太多无关像素
+bool touches(const SDL_Rect &a, const SDL_Rect &b) {
+  return a.x <= b.x + b.w && b.x <= a.x + a.w && a.y <= b.y + b.h &&
+         b.y <= a.y + a.h;
+}
+
+SDL_Rect unite(const SDL_Rect &a, const SDL_Rect &b) {
+  int x1 = std::min(a.x, b.x), y1 = std::min(a.y, b.y);
+  int x2 = std::max(a.x + a.w, b.x + b.w), y2 = std::max(a.y + a.h, b.y + b.h);
+  return {x1, y1, x2 - x1, y2 - y1};
+}
+
+long long area(const SDL_Rect &r) {
+  return static_cast<long long>(r.w) * r.h;
+}
+} // namespace
+
+void DirtyRegion::setBounds(int w, int h) {
+  m_width = w;
+  m_height = h;
+  clear();
+}
+
+void DirtyRegion::add(SDL_Rect rect) {
+  if (m_full)
+    return;
+
+  // 允许负的宽高，与 SDL 绘制矩形的习惯保持一致
+  if (rect.w < 0) {
+    rect.x += rect.w;
+    rect.w = -rect.w;
+  }
+  if (rect.h < 0) {
+    rect.y += rect.h;
+    rect.h = -rect.h;
+  }
+
+  // 裁剪到画布范围
+  int x1 = std::max(rect.x, 0), y1 = std::max(rect.y, 0);
+  int x2 = std::min(rect.x + rect.w, m_width);
+  int y2 = std::min(rect.y + rect.h, m_height);
+  if (x1 >= x2 || y1 >= y2)
+    return;
+  rect = {x1, y1, x2 - x1, y2 - y1};
+
+  // 与已有矩形反复合并，直到不再和任何矩形接触
+  for (std::size_t i = 0; i < m_rects.size();) {
+    if (touches(m_rects[i], rect)) {
+      rect = unite(m_rects[i], rect);
+      m_rects[i] = m_rects.back();
+      m_rects.pop_back();
+      i = 0;
+    } else {
+      ++i;
+    }
+  }
+  m_rects.push_back(rect);
+
+  if (m_rects.size() > kMaxRects)
+    collapse();
+}
+
+void DirtyRegion::collapse() {
+  SDL_Rect bounds = m_rects.front();
+  for (const auto &r : m_rects)
+    bounds = unite(bounds, r);
+  m_rects.assign(1, bounds);
+
+  // 包围盒超过画布一半时，逐块拷贝已经没有意义
+  if (area(bounds) * 2 >= static_cast<long long>(m_width) * m_height)
+    markAll();
+}
+
+void DirtyRegion::clear() {
+  m_full = false;
+  m_rects.clear();
+}
@@ -0,0 +1,183 @@
+#include <internal/draw_batch.h>
+
+namespace {
+bool sameColor(SDL_Color a, SDL_Color b) {
+  return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+} // namespace
+
+void DrawBatch::addRects(SDL_Color color, std::span<const SDL_FRect> rects) {
+  if (rects.empty())
+    return;
+
+  // 与上一条同色的填充命令直接合并：m_rects 是连续存放的，只需扩展区间
+  if (!m_commands.empty()) {
+    Command &last = m_commands.back();
+    if (last.kind == Kind::FillRects && sameColor(last.color, color) &&
+        last.first + last.count == m_rects.size()) {
+      m_rects.insert(m_rects.end(), rects.begin(), rects.end());
+      last.count += rects.size();
+      return;
+    }
+  }
+
+  Command cmd{};
+  cmd.kind = Kind::FillRects;
+  cmd.color = color;
+  cmd.first = m_rects.size();
+  cmd.count = rects.size();
+  m_rects.insert(m_rects.end(), rects.begin(), rects.end());
+  m_commands.push_back(cmd);
+}
+
+void DrawBatch::addLine(SDL_Color color, float x1, float y1, float x2,
+                        float y2) {
+  Command cmd{};
+  cmd.kind = Kind::Line;
+  cmd.color = color;
+  cmd.x1 = x1;
+  cmd.y1 = y1;
+  cmd.x2 = x2;
+  cmd.y2 = y2;
+  m_commands.push_back(cmd);
+}
+
+void DrawBatch::addText(SDL_Color color, float x, float y,
+                        std::string_view utf8) {
+  Command cmd{};
+  cmd.kind = Kind::Text;
+  cmd.color = color;
+  cmd.x1 = x;
+  cmd.y1 = y;
+  cmd.first = m_text.size();
+  cmd.count = utf8.size();
+  m_text.append(utf8);
+  m_text.push_back('\0');
+  m_commands.push_back(cmd);
+}
+
+void DrawBatch::addClear(SDL_Color color) {
+  // 清屏会覆盖之前的全部内容，之前记录的命令已经没有意义了
+  // 但混合模式的切换需要保留，否则会影响清屏之后的命令
+  SDL_BlendMode pendingMode = SDL_BLENDMODE_INVALID;
+  for (const auto &cmd : m_commands) {
+    if (cmd.kind == Kind::BlendMode)
+      pendingMode = cmd.blendMode;
+  }
+  clear();
+  if (pendingMode != SDL_BLENDMODE_INVALID)
+    addBlendMode(pendingMode);
+
+  Command cmd{};
+  cmd.kind = Kind::Clear;
+  cmd.color = color;
+  m_commands.push_back(cmd);
+}
+
+void DrawBatch::addBlendMode(SDL_BlendMode mode) {
+  Command cmd{};
+  cmd.kind = Kind::BlendMode;
+  cmd.blendMode = mode;
+  m_commands.push_back(cmd);
+}
+
+void DrawBatch::addGeometry(std::span<const SDL_Vertex> vertices,
+                            std::span<const int> indices,
+                            SDL_Texture *texture) {
+  if (vertices.empty() || indices.empty())
+    return;
+
+  Command *target = nullptr;
+  if (!m_commands.empty()) {
+    Command &last = m_commands.back();
+    if (last.kind == Kind::Geometry && last.texture == texture &&
+        last.first + last.count == m_vertices.size() &&
+        last.indexFirst + last.indexCount == m_indices.size())
+      target = &last;
+  }
+  if (!target) {
+    Command cmd{};
+    cmd.kind = Kind::Geometry;
+    cmd.texture = texture;
+    cmd.first = m_vertices.size();
+    cmd.indexFirst = m_indices.size();
+    m_commands.push_back(cmd);
+    target = &m_commands.back();
+  }
+
+  // 合并后索引要加上该命令中已有的顶点数
+  const int base = static_cast<int>(target->count);
+  m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
+  for (int index : indices)
+    m_indices.push_back(base + index);
+  target->count += vertices.size();
+  target->indexCount += indices.size();
+}
+
+bool DrawBatch::submit(SDL_Renderer *renderer, TextDrawer drawText) {
+  bool ok = true;
+  bool hasColor = false;
+  SDL_Color current{};
+
+  // 只在颜色真正变化时才修改 DrawColor
+  auto useColor = [&](SDL_Color color) {
+    if (!hasColor || !sameColor(current, color)) {
+      ok = SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b,
+                                  color.a) &&
+           ok;
+      current = color;
+      hasColor = true;
+    }
+  };
+
+  for (const auto &cmd : m_commands) {
+    switch (cmd.kind) {
+    case Kind::FillRects:
+      useColor(cmd.color);
+      ok = SDL_RenderFillRects(renderer, m_rects.data() + cmd.first,
+                               static_cast<int>(cmd.count)) &&
+           ok;
+      break;
+    case Kind::Line:
+      useColor(cmd.color);
+      ok = SDL_RenderLine(renderer, cmd.x1, cmd.y1, cmd.x2, cmd.y2) && ok;
+      break;
+    case Kind::Text:
+      ok = drawText(cmd.x1, cmd.y1, m_text.data() + cmd.first, cmd.color) &&
+           ok;
+      break;
+    case Kind::Clear:
+      useColor(cmd.color);
+      ok = SDL_RenderClear(renderer) && ok;
+      break;
+    case Kind::BlendMode:
+      ok = SDL_SetRenderDrawBlendMode(renderer, cmd.blendMode) && ok;
+      break;
+    case Kind::Geometry:
+      // 颜色来自顶点，不受 DrawColor 影响；纹理自己的混合模式需要跟随当前的设置
+      if (cmd.texture) {
+        SDL_BlendMode mode;
+        ok = SDL_GetRenderDrawBlendMode(renderer, &mode) &&
+             SDL_SetTextureBlendMode(cmd.texture, mode) && ok;
+      }
+      ok = SDL_RenderGeometry(renderer, cmd.texture,
+                              m_vertices.data() + cmd.first,
+                              static_cast<int>(cmd.count),
+                              m_indices.data() + cmd.indexFirst,
+                              static_cast<int>(cmd.indexCount)) &&
+           ok;
+      break;
+    }
+  }
+
+  clear();
+  return ok;
+}
+
+void DrawBatch::clear() {
+  m_commands.clear();
+  m_rects.clear();
+  m_vertices.clear();
+  m_indices.clear();
+  m_text.clear();
+}
@@ -0,0 +1,38 @@
+#include <internal/font_metrics.h>
+#include <internal/glyph_atlas.h>
+
+void FontMetrics::init(TTF_Font *font, GlyphAtlas *atlas) {
+  reset();
+  m_font = font;
+  m_atlas = atlas;
+  m_height = TTF_GetFontHeight(font);
+  m_spaceWidth = measure(" ");
+}
+
+void FontMetrics::reset() {
+  m_font = nullptr;
+  m_atlas = nullptr;
+  m_spaceWidth = 0;
+  m_height = 0;
+  m_memo.clear();
+}
+
+int FontMetrics::measure(std::string_view utf8) {
+  if (!m_font || utf8.empty())
+    return 0;
+
+  int width = 0;
+  if (m_atlas && m_atlas->enabled() && m_atlas->measure(utf8, &width))
+    return width;
+
+  if (auto it = m_memo.find(utf8); it != m_memo.end())
+    return it->second;
+
+  TTF_MeasureString(m_font, utf8.data(), utf8.size(), 0, &width, nullptr);
+
+  // 简单地限制缓存大小：满了就整体清空，避免不断变化的字符串让缓存无限增长
+  if (m_memo.size() >= kMaxMemoEntries)
+    m_memo.clear();
+  m_memo.emplace(utf8, width);
+  return width;
+}
@@ -2,9 +2,14 @@
 #define _CRT_SECURE_NO_WARNINGS
 
 #include <cstdio>
+#include <fstream>
 #include <print>
+#include <string_view>
+#include <system_error>
 
 #include <SDL3/SDL_assert.h>
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_stdinc.h>
 #include <fontconfig/fontconfig.h>
 #include <internal/font_utils.h>
 
@@ -18,12 +23,115 @@ struct StderrMaskGuard {
 };
 #endif
 
+namespace {
+constexpr std::string_view kCacheHeader = "libbgt-font-stack 1";
+
+std::uint64_t fnv1a(std::string_view data,
+                    std::uint64_t hash = 0xcbf29ce484222325ull) {
+  for (unsigned char ch : data) {
+    hash ^= ch;
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+// 只取各个目录本身的修改时间，不遍历目录树，否则启动时的开销与扫描字体相当。
+// 字体装进子目录后 fc-cache 会在缓存目录中写入新的缓存文件，缓存目录的修改时间随之改变
+std::uint64_t hashDirs(FcStrList *dirs, std::uint64_t hash) {
+  if (!dirs)
+    return hash;
+  while (FcChar8 *dir = FcStrListNext(dirs)) {
+    const char *name = reinterpret_cast<const char *>(dir);
+    hash = fnv1a(name, hash);
+    // 不存在的目录也参与计算，之后被创建时标记同样会变化
+    std::error_code ec;
+    const auto time = fs::last_write_time(fs::path{name}, ec);
+    const auto ticks = ec ? 0 : time.time_since_epoch().count();
+    hash = fnv1a(std::string_view(reinterpret_cast<const char *>(&ticks),
+                                  sizeof(ticks)),
+                 hash);
+  }
+  FcStrListDone(dirs);
+  return hash;
+}
+
+// 每个查询一个文件，文件名由查询条件决定
+fs::path cacheFile(std::string_view queryText) {
+  char *pref = SDL_GetPrefPath("libbgt", "fonts");
+  if (!pref)
+    return {};
+  fs::path dir{std::u8string_view(reinterpret_cast<const char8_t *>(pref))};
+  SDL_free(pref);
+  char name[32];
+  std::snprintf(name, sizeof(name), "stack-%016llx.txt",
+                static_cast<unsigned long long>(fnv1a(queryText)));
+  return dir / name;
+}
+
+// 文件格式：第一行为格式标识，第二行为查询条件，第三行为标记，之后每行一个字体文件路径
+bool readCache(const fs::path &file, std::string_view queryText,
+               std::uint64_t stamp, std::vector<std::string> &paths) {
+  std::ifstream in(file, std::ios::binary);
+  std::string header, query, stampText;
+  if (!std::getline(in, header) || header != kCacheHeader ||
+      !std::getline(in, query) || query != queryText ||
+      !std::getline(in, stampText) || stampText != std::to_string(stamp))
+    return false;
+  for (std::string line; std::getline(in, line);) {
+    // 字体被删除了但目录的修改时间没有变化（例如删除的是子目录中的文件）
+    std::error_code ec;
+    if (!fs::exists(fs::path{line}, ec))
+      return false;
+    paths.push_back(std::move(line));
+  }
+  return !paths.empty();
+}
+
+void writeCache(const fs::path &file, std::string_view queryText,
+                std::uint64_t stamp, const std::vector<std::string> &paths) {
+  // 先写入临时文件再改名，另一个同时启动的程序不会读到写了一半的缓存
+  fs::path temp = file;
+  temp += ".tmp";
+  {
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    out << kCacheHeader << '\n' << queryText << '\n' << stamp << '\n';
+    for (const auto &path : paths)
+      out << path << '\n';
+    if (!out)
+      return;
+  }
+  std::error_code ec;
+  fs::rename(temp, file, ec);
+  if (ec)
+    fs::remove(temp, ec);
+}
+} // namespace
+
 FontManager::FontManager() {
 #ifdef _WIN32
   // 在 Windows 上屏蔽 FontConfig 的错误输出
   StderrMaskGuard _{};
 #endif
-  m_config.reset(FcInitLoadConfigAndFonts());
+  // 只读取配置文件，扫描字体推迟到 fonts() 中，缓存命中时就不需要了
+  m_config.reset(FcInitLoadConfig());
+}
+
+FcConfig *FontManager::fonts() const {
+  if (!m_fontsBuilt) {
+#ifdef _WIN32
+    StderrMaskGuard _{};
+#endif
+    FcConfigBuildFonts(m_config.get());
+    m_fontsBuilt = true;
+  }
+  return m_config.get();
+}
+
+std::uint64_t FontManager::cacheStamp() const {
+  std::uint64_t hash = fnv1a("cache");
+  hash = hashDirs(FcConfigGetCacheDirs(m_config.get()), hash);
+  hash = fnv1a("fonts", hash);
+  return hashDirs(FcConfigGetFontDirs(m_config.get()), hash);
 }
 
 auto FontManager::internal_resolve(const FontQuery &query) const -> FontSetPtr {
@@ -33,7 +141,7 @@ auto FontManager::internal_resolve(const FontQuery &query) const -> FontSetPtr {
 
   // 2. 配置替换 (System Config Substitution)
   // 处理 Alias (如 Helvetica -> sans-serif -> Noto Sans)
-  FcConfigSubstitute(m_config.get(), pat.get(), FcMatchPattern);
+  FcConfigSubstitute(fonts(), pat.get(), FcMatchPattern);
 
   // 3. 默认值替换 (Default Substitution)
   // 填充未指定的属性 (如 size, weight 默认值)
@@ -50,33 +158,49 @@ auto FontManager::internal_resolve(const FontQuery &query) const -> FontSetPtr {
   FcResult result;
   // trim 参数设为 FcTrue，表示移除那些没有包含"新字符"的字体，优化列表长度
   FontSetPtr fontSet(
-      FcFontSort(m_config.get(), pat.get(), FcTrue, nullptr, &result));
+      FcFontSort(fonts(), pat.get(), FcTrue, nullptr, &result));
   return fontSet;
 }
 
 auto FontManager::resolve(const FontQuery &query) const
     -> std::vector<fs::path> {
-  auto fontSet = internal_resolve(query);
-  if (!fontSet)
-    return {};
-
-  // 5. 遍历结果并提取文件路径
-  std::vector<fs::path> resultPaths;
+  std::string queryText;
+  if (FcChar8 *text = FcNameUnparse(query.get())) {
+    queryText = reinterpret_cast<const char *>(text);
+    FcStrFree(text);
+  }
+  const std::uint64_t stamp = cacheStamp();
+  const fs::path file = cacheFile(queryText);
 
-  for (int i = 0; i < fontSet->nfont; ++i) {
-    FcPattern *font = fontSet->fonts[i];
-    FcChar8 *file = nullptr;
+  std::vector<std::string> files;
+  if (file.empty() || !readCache(file, queryText, stamp, files)) {
+    files.clear();
+    auto fontSet = internal_resolve(query);
+    if (!fontSet)
+      return {};
 
-    // 从 Pattern 中提取文件名
-    if (FcPatternGetString(font, FC_FILE, 0, &file) == FcResultMatch) {
-      // 转换为 fs::path
-      fs::path p{reinterpret_cast<char *>(file)};
-      using namespace std::string_literals;
-      SDL_assert(fs::exists(p) &&
-                 ("Font file does not exist: "s + p.string()).c_str());
+    // 5. 遍历结果并提取文件路径
+    for (int i = 0; i < fontSet->nfont; ++i) {
+      FcPattern *font = fontSet->fonts[i];
+      FcChar8 *fontFile = nullptr;
 
-      resultPaths.push_back(std::move(p));
+      // 从 Pattern 中提取文件名
+      if (FcPatternGetString(font, FC_FILE, 0, &fontFile) == FcResultMatch)
+        files.emplace_back(reinterpret_cast<char *>(fontFile));
     }
+    if (!file.empty() && !files.empty())
+      writeCache(file, queryText, stamp, files);
+  }
+
+  std::vector<fs::path> resultPaths;
+  for (const auto &name : files) {
+    // 转换为 fs::path
+    fs::path p{name};
+    using namespace std::string_literals;
+    SDL_assert(fs::exists(p) &&
+               ("Font file does not exist: "s + p.string()).c_str());
+
+    resultPaths.push_back(std::move(p));
   }
 
   return resultPaths;
@@ -91,7 +215,7 @@ auto FontManager::listChineseFamilies() const -> std::vector<std::string> {
 
   FcObjectSet *os = FcObjectSetBuild(FC_FAMILY, FC_FAMILYLANG, nullptr);
 
-  FontSetPtr fs(FcFontList(m_config.get(), pat.get(), os));
+  FontSetPtr fs(FcFontList(fonts(), pat.get(), os));
 
   FcObjectSetDestroy(os);
 
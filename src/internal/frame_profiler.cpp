@@ -0,0 +1,95 @@
+#include <internal/frame_profiler.h>
+
+#include <SDL3/SDL_timer.h>
+
+void FrameProfiler::enter(Zone zone) {
+  accumulateActive(SDL_GetPerformanceCounter());
+  m_active = zone;
+}
+
+void FrameProfiler::leave(int outer) {
+  accumulateActive(SDL_GetPerformanceCounter());
+  m_active = outer;
+}
+
+void FrameProfiler::setEnabled(bool enabled) {
+  if (enabled == m_enabled)
+    return;
+  reset();
+  m_enabled = enabled;
+}
+
+void FrameProfiler::accumulateActive(Uint64 now) {
+  if (m_active >= 0)
+    m_ticks[m_active] += now - m_activeStart;
+  m_activeStart = now;
+}
+
+void FrameProfiler::moveToZone(Zone zone, Uint64 ticks) {
+  if (!m_enabled || m_active < 0 || m_active == zone)
+    return;
+  // 当前区间的时间要到暂停时才累加，这里先减去，暂停时自然补回
+  m_ticks[m_active] -= ticks;
+  m_ticks[zone] += ticks;
+}
+
+void FrameProfiler::endFrame(unsigned long long pixelsTotal,
+                             unsigned long long cacheHits,
+                             unsigned long long cacheMisses) {
+  if (!m_enabled)
+    return;
+  const Uint64 nowNs = SDL_GetTicksNS();
+  // 正在计时的区间先结算到本帧
+  accumulateActive(SDL_GetPerformanceCounter());
+
+  const double msPerTick = 1000.0 / double(SDL_GetPerformanceFrequency());
+  m_last.frameMs = m_frameStartNs ? double(nowNs - m_frameStartNs) / 1e6 : 0;
+  for (int zone = 0; zone < kZoneCount; zone++)
+    m_last.zoneMs[zone] = double(m_ticks[zone]) * msPerTick;
+  m_last.drawCalls = m_drawCalls;
+  m_last.pixels = pixelsTotal - m_pixelsBase;
+  m_last.cacheHits = cacheHits - m_hitsBase;
+  m_last.cacheMisses = cacheMisses - m_missesBase;
+
+  if (m_frameStartNs) {
+    m_history[m_historyNext] = static_cast<float>(m_last.frameMs);
+    m_historyNext = (m_historyNext + 1) % kHistorySize;
+    if (m_historyCount < kHistorySize)
+      m_historyCount++;
+  }
+
+  m_frameStartNs = nowNs;
+  m_ticks.fill(0);
+  m_drawCalls = 0;
+  rebase(pixelsTotal, cacheHits, cacheMisses);
+}
+
+void FrameProfiler::rebase(unsigned long long pixelsTotal,
+                           unsigned long long cacheHits,
+                           unsigned long long cacheMisses) {
+  m_pixelsBase = pixelsTotal;
+  m_hitsBase = cacheHits;
+  m_missesBase = cacheMisses;
+}
+
+void FrameProfiler::reset() {
+  const bool enabled = m_enabled;
+  *this = FrameProfiler();
+  m_enabled = enabled;
+}
+
+double FrameProfiler::fps() const {
+  double totalMs = 0;
+  std::size_t frames = 0;
+  while (frames < m_historyCount && totalMs < 1000) {
+    totalMs += historyAt(m_historyCount - 1 - frames);
+    frames++;
+  }
+  return totalMs > 0 ? frames * 1000.0 / totalMs : 0;
+}
+
+float FrameProfiler::historyAt(std::size_t index) const {
+  const std::size_t oldest =
+      (m_historyNext + kHistorySize - m_historyCount) % kHistorySize;
+  return m_history[(oldest + index) % kHistorySize];
+}
@@ -0,0 +1,190 @@
+#include <algorithm>
+
+#include <internal/glyph_atlas.h>
+
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_surface.h>
+
+namespace {
+// 字形之间留 1 像素空隙，避免缩放采样时串到相邻字形
+constexpr int kPadding = 1;
+} // namespace
+
+void GlyphAtlas::init(SDL_Renderer *renderer, TTF_Font *font) {
+  reset();
+  m_renderer = renderer;
+  m_font = font;
+  m_lineHeight = TTF_GetFontHeight(font);
+
+  // 预先加载所有可打印 ASCII 字符，数字与英文就不会在第一次绘制时卡顿
+  for (Uint32 ch = 32; ch < 127; ++ch)
+    glyph(ch);
+}
+
+void GlyphAtlas::reset() {
+  for (auto *page : m_pages)
+    SDL_DestroyTexture(page);
+  m_pages.clear();
+  m_glyphs.clear();
+  m_ascii.fill(Glyph{});
+  m_penX = m_penY = 0;
+  m_renderer = nullptr;
+  m_font = nullptr;
+}
+
+auto GlyphAtlas::glyph(Uint32 codepoint) -> const Glyph & {
+  Glyph &slot = codepoint < m_ascii.size() ? m_ascii[codepoint]
+                                            : m_glyphs[codepoint];
+  if (!slot.loaded)
+    slot = rasterize(codepoint);
+  return slot;
+}
+
+auto GlyphAtlas::rasterize(Uint32 codepoint) -> Glyph {
+  Glyph result;
+  result.loaded = true;
+
+  // 控制字符（如换行）涉及多行排版，交给常规路径处理
+  // 主字体中没有的字形会落到后备字体上，而后备字体不一定是等宽的
+  if (codepoint < 32 || codepoint == 127 || !TTF_FontHasGlyph(m_font, codepoint))
+    return result;
+
+  int advance = 0;
+  if (!TTF_GetGlyphMetrics(m_font, codepoint, nullptr, nullptr, nullptr,
+                           nullptr, &advance))
+    return result;
+  result.advance = advance;
+
+  // 用白色光栅化，绘制时再通过顶点颜色调制成任意颜色
+  SDL_Surface *surface =
+      TTF_RenderGlyph_Blended(m_font, codepoint, SDL_Color{255, 255, 255, 255});
+  if (!surface) {
+    // 空格之类没有像素的字形渲染会失败，但仍然占据宽度
+    result.supported = true;
+    return result;
+  }
+
+  SDL_Surface *converted = surface;
+  if (surface->format != SDL_PIXELFORMAT_ARGB8888)
+    converted = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_ARGB8888);
+
+  int page = 0, x = 0, y = 0;
+  if (converted && allocate(converted->w, converted->h, page, x, y)) {
+    const SDL_Rect dst{x, y, converted->w, converted->h};
+    if (SDL_UpdateTexture(m_pages[page], &dst, converted->pixels,
+                          converted->pitch)) {
+      result.supported = true;
+      result.page = page;
+      result.src = {float(x), float(y), float(converted->w),
+                    float(converted->h)};
+    }
+  }
+
+  if (converted != surface)
+    SDL_DestroySurface(converted);
+  SDL_DestroySurface(surface);
+  return result;
+}
+
+bool GlyphAtlas::allocate(int w, int h, int &page, int &x, int &y) {
+  if (w + kPadding > kPageSize || h + kPadding > kPageSize)
+    return false;
+
+  const int rowHeight = std::max(m_lineHeight, h) + kPadding;
+  if (!m_pages.empty() && m_penX + w + kPadding > kPageSize) {
+    // 换行
+    m_penX = 0;
+    m_penY += rowHeight;
+  }
+  if (m_pages.empty() || m_penY + rowHeight > kPageSize) {
+    // 当前页已满，开一页新的
+    auto *texture =
+        SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_ARGB8888,
+                          SDL_TEXTUREACCESS_STATIC, kPageSize, kPageSize);
+    if (!texture)
+      return false;
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    m_pages.push_back(texture);
+    m_penX = m_penY = 0;
+  }
+
+  page = static_cast<int>(m_pages.size()) - 1;
+  x = m_penX;
+  y = m_penY;
+  m_penX += w + kPadding;
+  return true;
+}
+
+bool GlyphAtlas::measure(std::string_view utf8, int *width) {
+  int total = 0;
+  const char *p = utf8.data();
+  size_t len = utf8.size();
+  while (len > 0) {
+    Uint32 codepoint = SDL_StepUTF8(&p, &len);
+    if (codepoint == 0 || codepoint == SDL_INVALID_UNICODE_CODEPOINT)
+      return false;
+    const Glyph &g = glyph(codepoint);
+    if (!g.supported)
+      return false;
+    total += g.advance;
+  }
+  if (width)
+    *width = total;
+  return true;
+}
+
+bool GlyphAtlas::draw(std::string_view utf8, float x, float y,
+                      SDL_Color color) {
+  m_vertices.clear();
+  m_indices.clear();
+  m_pageOfQuad.clear();
+
+  const SDL_FColor fcolor{color.r / 255.0F, color.g / 255.0F,
+                          color.b / 255.0F, color.a / 255.0F};
+  const float inv = 1.0F / kPageSize;
+
+  // 先把所有字形转换为四边形，遇到不支持的字符就整体放弃
+  float penX = x;
+  const char *p = utf8.data();
+  size_t len = utf8.size();
+  while (len > 0) {
+    Uint32 codepoint = SDL_StepUTF8(&p, &len);
+    if (codepoint == 0 || codepoint == SDL_INVALID_UNICODE_CODEPOINT)
+      return false;
+    const Glyph &g = glyph(codepoint);
+    if (!g.supported)
+      return false;
+
+    if (g.src.w > 0) {
+      const SDL_FRect &s = g.src;
+      const float u0 = s.x * inv, v0 = s.y * inv;
+      const float u1 = (s.x + s.w) * inv, v1 = (s.y + s.h) * inv;
+      m_vertices.push_back({{penX, y}, fcolor, {u0, v0}});
+      m_vertices.push_back({{penX + s.w, y}, fcolor, {u1, v0}});
+      m_vertices.push_back({{penX + s.w, y + s.h}, fcolor, {u1, v1}});
+      m_vertices.push_back({{penX, y + s.h}, fcolor, {u0, v1}});
+      m_pageOfQuad.push_back(g.page);
+    }
+    penX += g.advance;
+  }
+
+  // 按图集页分组提交，通常所有字形都在第一页上，只需一次调用
+  bool ok = true;
+  for (int page = 0; page < static_cast<int>(m_pages.size()); ++page) {
+    m_indices.clear();
+    for (int quad = 0; quad < static_cast<int>(m_pageOfQuad.size()); ++quad) {
+      if (m_pageOfQuad[quad] != page)
+        continue;
+      const int base = quad * 4;
+      m_indices.insert(m_indices.end(), {base, base + 1, base + 2, base,
+                                         base + 2, base + 3});
+    }
+    if (!m_indices.empty())
+      ok = SDL_RenderGeometry(m_renderer, m_pages[page], m_vertices.data(),
+                              static_cast<int>(m_vertices.size()),
+                              m_indices.data(),
+                              static_cast<int>(m_indices.size())) &&
+           ok;
+  }
+  return ok;
+}
@@ -0,0 +1,216 @@
+#include <internal/image_cache.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include <vector>
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_properties.h>
+#include <SDL3_image/SDL_image.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+// "a.png"、"./a.png" 与 "dir/../a.png" 指向同一个文件，应当共用一份纹理
+std::string cacheKey(const char *utf8Path) {
+  const fs::path path(
+      std::u8string_view(reinterpret_cast<const char8_t *>(utf8Path)));
+  std::error_code ec;
+  fs::path canonical = fs::weakly_canonical(path, ec);
+  if (ec)
+    canonical = path.lexically_normal();
+  const std::u8string key = canonical.u8string();
+  return std::string(key.begin(), key.end());
+}
+
+int maxTextureSize(SDL_Renderer *renderer) {
+  return static_cast<int>(SDL_GetNumberProperty(
+      SDL_GetRendererProperties(renderer),
+      SDL_PROP_RENDERER_MAX_TEXTURE_SIZE_NUMBER, 0));
+}
+
+// 把图片复制到四周各扩出 padding 像素的缓冲区中，扩出的部分重复边缘的像素
+std::vector<Uint32> padPixels(const SDL_Surface *surface, int padding) {
+  const int w = surface->w, h = surface->h;
+  const int paddedW = w + 2 * padding, paddedH = h + 2 * padding;
+  std::vector<Uint32> pixels(std::size_t(paddedW) * paddedH);
+  for (int y = 0; y < paddedH; y++) {
+    const int srcY = std::clamp(y - padding, 0, h - 1);
+    const auto *src = reinterpret_cast<const Uint32 *>(
+        static_cast<const Uint8 *>(surface->pixels) +
+        std::size_t(srcY) * surface->pitch);
+    Uint32 *dst = pixels.data() + std::size_t(y) * paddedW;
+    for (int x = 0; x < paddedW; x++)
+      dst[x] = src[std::clamp(x - padding, 0, w - 1)];
+  }
+  return pixels;
+}
+} // namespace
+
+int ImageCache::addPage(SDL_Renderer *renderer, int size) {
+  SDL_Texture *texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                                           SDL_TEXTUREACCESS_STATIC, size, size);
+  if (!texture)
+    return -1;
+  // 新建的纹理内容不确定，先整体清为透明
+  const std::vector<Uint32> transparent(std::size_t(size) * size, 0);
+  if (!SDL_UpdateTexture(texture, nullptr, transparent.data(),
+                         size * static_cast<int>(sizeof(Uint32)))) {
+    SDL_DestroyTexture(texture);
+    return -1;
+  }
+
+  Page page;
+  page.texture = texture;
+  page.packer.init(size, size);
+  page.size = size;
+  // 优先复用已经释放的图集位置
+  auto slot = std::ranges::find(m_pages, nullptr, &Page::texture);
+  if (slot == m_pages.end())
+    slot = m_pages.insert(m_pages.end(), std::move(page));
+  else
+    *slot = std::move(page);
+  return static_cast<int>(slot - m_pages.begin());
+}
+
+bool ImageCache::pack(SDL_Renderer *renderer, SDL_Surface *surface,
+                      Entry &entry) {
+  const int maxSize = maxTextureSize(renderer);
+  const int size = maxSize > 0 ? std::min(m_atlasSize, maxSize) : m_atlasSize;
+  const int paddedW = surface->w + 2 * kPadding;
+  const int paddedH = surface->h + 2 * kPadding;
+  // 大图片装进图集没有好处，反而会很快占满图集
+  if (size <= 0 || surface->w <= 0 || surface->h <= 0 ||
+      paddedW > size / 2 || paddedH > size / 2)
+    return false;
+
+  SDL_Surface *converted = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA8888);
+  if (!converted)
+    return false;
+  const std::vector<Uint32> pixels = padPixels(converted, kPadding);
+  SDL_DestroySurface(converted);
+
+  // 先在副本上找位置，上传成功之后才真正占用，失败时图集保持原样
+  int x = 0, y = 0;
+  std::size_t index = 0;
+  SkylinePacker packer;
+  for (; index < m_pages.size(); index++) {
+    const Page &page = m_pages[index];
+    if (!page.texture || page.size != size)
+      continue;
+    packer = page.packer;
+    if (packer.insert(paddedW, paddedH, x, y))
+      break;
+  }
+  const bool addedPage = index == m_pages.size();
+  if (addedPage) {
+    const int added = addPage(renderer, size);
+    if (added < 0)
+      return false;
+    index = static_cast<std::size_t>(added);
+    packer = m_pages[index].packer;
+  }
+
+  Page &page = m_pages[index];
+  bool uploaded = !addedPage || packer.insert(paddedW, paddedH, x, y);
+  if (uploaded) {
+    const SDL_Rect area = {x, y, paddedW, paddedH};
+    uploaded = SDL_UpdateTexture(page.texture, &area, pixels.data(),
+                                 paddedW * static_cast<int>(sizeof(Uint32)));
+  }
+  if (!uploaded) {
+    // 专门为这张图片新建的图集不留空着
+    if (addedPage) {
+      SDL_DestroyTexture(page.texture);
+      page = Page{};
+    }
+    return false;
+  }
+  page.packer = std::move(packer);
+  page.images++;
+  entry.page = static_cast<int>(index);
+  entry.image.texture = page.texture;
+  entry.image.region = {float(x + kPadding), float(y + kPadding),
+                        float(surface->w), float(surface->h)};
+  entry.image.textureWidth = entry.image.textureHeight = float(size);
+  return true;
+}
+
+int ImageCache::acquire(SDL_Renderer *renderer, const char *utf8Path) {
+  std::string key = cacheKey(utf8Path);
+  if (auto it = m_handles.find(key); it != m_handles.end()) {
+    m_entries[it->second - 1].refs++;
+    return it->second;
+  }
+
+  SDL_Surface *surface = IMG_Load(utf8Path);
+  if (!surface)
+    return 0;
+  Entry entry;
+  entry.image.width = surface->w;
+  entry.image.height = surface->h;
+  entry.key = key;
+  entry.refs = 1;
+  if (!pack(renderer, surface, entry)) {
+    // 装不进图集（或者没有启用图集）时单独创建纹理
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+    if (!texture) {
+      SDL_DestroySurface(surface);
+      return 0;
+    }
+    entry.image.texture = texture;
+    entry.image.region = {0, 0, float(surface->w), float(surface->h)};
+    entry.image.textureWidth = float(surface->w);
+    entry.image.textureHeight = float(surface->h);
+  }
+  SDL_DestroySurface(surface);
+
+  auto slot = std::ranges::find_if(
+      m_entries, [](const Entry &e) { return e.image.texture == nullptr; });
+  if (slot == m_entries.end())
+    slot = m_entries.insert(m_entries.end(), std::move(entry));
+  else
+    *slot = std::move(entry);
+  const int handle = static_cast<int>(slot - m_entries.begin()) + 1;
+  m_handles.emplace(std::move(key), handle);
+  return handle;
+}
+
+bool ImageCache::release(int handle) {
+  if (!find(handle))
+    return SDL_SetError("Invalid image: %d", handle);
+  Entry &entry = m_entries[handle - 1];
+  if (--entry.refs > 0)
+    return true;
+  if (entry.page < 0) {
+    SDL_DestroyTexture(entry.image.texture);
+  } else if (--m_pages[entry.page].images == 0) {
+    SDL_DestroyTexture(m_pages[entry.page].texture);
+    m_pages[entry.page] = Page{};
+  }
+  m_handles.erase(entry.key);
+  entry = Entry{};
+  return true;
+}
+
+const ImageCache::Image *ImageCache::find(int handle) const {
+  if (handle < 1 || handle > static_cast<int>(m_entries.size()) ||
+      !m_entries[handle - 1].image.texture)
+    return nullptr;
+  return &m_entries[handle - 1].image;
+}
+
+void ImageCache::clear() {
+  for (auto &entry : m_entries) {
+    if (entry.image.texture && entry.page < 0)
+      SDL_DestroyTexture(entry.image.texture);
+  }
+  for (auto &page : m_pages) {
+    if (page.texture)
+      SDL_DestroyTexture(page.texture);
+  }
+  m_entries.clear();
+  m_pages.clear();
+  m_handles.clear();
+}
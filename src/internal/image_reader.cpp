@@ -0,0 +1,89 @@
+#include <internal/image_reader.h>
+#include <internal/image_utils.h>
+
+#include <cctype>
+#include <cstring>
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3_image/SDL_image.h>
+
+namespace {
+// 读取 PPM 头部的一个十进制数，跳过其前面的空白与注释
+bool readHeaderNumber(const Uint8 *&p, const Uint8 *end, int &value) {
+  while (p < end) {
+    if (*p == '#') {
+      while (p < end && *p != '\n')
+        p++;
+    } else if (std::isspace(*p)) {
+      p++;
+    } else {
+      break;
+    }
+  }
+  if (p == end || !std::isdigit(*p))
+    return false;
+  value = 0;
+  while (p < end && std::isdigit(*p)) {
+    value = value * 10 + (*p++ - '0');
+    if (value > 1 << 16)
+      return false;
+  }
+  return true;
+}
+
+SDL_Surface *parsePpm(const char *path, const Uint8 *p, const Uint8 *end) {
+  if (end - p < 2 || p[0] != 'P' || p[1] != '6') {
+    SDL_SetError("%s is not a binary PPM file", path);
+    return nullptr;
+  }
+  p += 2;
+  int w, h, maxValue;
+  if (!readHeaderNumber(p, end, w) || !readHeaderNumber(p, end, h) ||
+      !readHeaderNumber(p, end, maxValue) || maxValue != 255 || p == end) {
+    SDL_SetError("%s has an unsupported PPM header", path);
+    return nullptr;
+  }
+  // 头部与像素数据之间恰好有一个空白字符
+  p++;
+  const std::size_t rowBytes = std::size_t(w) * 3;
+  if (std::size_t(end - p) < rowBytes * h) {
+    SDL_SetError("%s is truncated", path);
+    return nullptr;
+  }
+  SDL_Surface *surface = SDL_CreateSurface(w, h, SDL_PIXELFORMAT_RGB24);
+  if (!surface)
+    return nullptr;
+  for (int y = 0; y < h; y++) {
+    std::memcpy(static_cast<Uint8 *>(surface->pixels) + std::size_t(y) * surface->pitch,
+                p + y * rowBytes, rowBytes);
+  }
+  return surface;
+}
+
+SDL_Surface *loadPpm(const char *path) {
+  std::size_t size = 0;
+  auto *data = static_cast<Uint8 *>(SDL_LoadFile(path, &size));
+  if (!data)
+    return nullptr;
+  SDL_Surface *surface = parsePpm(path, data, data + size);
+  SDL_free(data);
+  return surface;
+}
+} // namespace
+
+SDL_Surface *loadImage(const char *utf8Path) {
+  if (hasExtension(utf8Path, ".ppm"))
+    return loadPpm(utf8Path);
+  const bool png = hasExtension(utf8Path, ".png");
+  if (!png && !hasExtension(utf8Path, ".bmp")) {
+    SDL_SetError("Unsupported reference image format: %s", utf8Path);
+    return nullptr;
+  }
+  // PNG 交给 SDL_image 解码，它可以读取 bgt_save_frame 写出的不压缩 PNG
+  SurfacePtr image(png ? IMG_Load(utf8Path) : SDL_LoadBMP(utf8Path));
+  if (!image)
+    return nullptr;
+  return SDL_ConvertSurface(image.get(), SDL_PIXELFORMAT_RGB24);
+}
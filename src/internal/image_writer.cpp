@@ -0,0 +1,54 @@
+#include <internal/image_writer.h>
+#include <internal/image_utils.h>
+
+#include <string>
+#include <vector>
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3_image/SDL_image.h>
+
+namespace {
+using Bytes = std::vector<Uint8>;
+
+bool writeFile(const char *path, const Bytes &data) {
+  SDL_IOStream *io = SDL_IOFromFile(path, "wb");
+  if (!io)
+    return false;
+  const bool written = SDL_WriteIO(io, data.data(), data.size()) == data.size();
+  return SDL_CloseIO(io) && written;
+}
+
+Bytes encodePpm(int w, int h, const Uint8 *rgb, int pitch) {
+  const std::string header =
+      "P6\n" + std::to_string(w) + " " + std::to_string(h) + "\n255\n";
+  const std::size_t rowBytes = std::size_t(w) * 3;
+  Bytes ppm(header.begin(), header.end());
+  ppm.reserve(header.size() + rowBytes * h);
+  for (int y = 0; y < h; y++) {
+    const Uint8 *row = rgb + std::size_t(y) * pitch;
+    ppm.insert(ppm.end(), row, row + rowBytes);
+  }
+  return ppm;
+}
+} // namespace
+
+bool saveImage(const char *utf8Path, SDL_Surface *surface) {
+  const bool png = hasExtension(utf8Path, ".png");
+  const bool ppm = hasExtension(utf8Path, ".ppm");
+  if (!png && !ppm && !hasExtension(utf8Path, ".bmp"))
+    return SDL_SetError("Unsupported image format: %s", utf8Path);
+
+  SurfacePtr rgb(SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGB24));
+  if (!rgb)
+    return false;
+  if (png)
+    return IMG_SavePNG(rgb.get(), utf8Path);
+  if (!ppm)
+    return SDL_SaveBMP(rgb.get(), utf8Path);
+
+  return writeFile(utf8Path,
+                   encodePpm(rgb->w, rgb->h,
+                             static_cast<const Uint8 *>(rgb->pixels),
+                             rgb->pitch));
+}
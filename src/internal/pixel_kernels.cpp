@@ -0,0 +1,300 @@
+#include <internal/pixel_kernels.h>
+
+#include <algorithm>
+
+#include <SDL3/SDL_cpuinfo.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||            \
+    defined(_M_IX86)
+#define BGT_PIXEL_KERNELS_X86 1
+#include <immintrin.h>
+// GCC 与 Clang 需要为使用高级指令集的函数单独开启该指令集，
+// 这样整个库无需以 -mavx2 编译，不支持的 CPU 上也不会执行到这些函数；MSVC 不需要
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+#endif
+
+namespace {
+// ------------------------------------------
+// 标量版本，也用于处理 SIMD 版本剩余的尾部像素
+// ------------------------------------------
+
+// x * y / 255 并舍入到最近整数
+inline Uint32 mul255(Uint32 x, Uint32 y) {
+  Uint32 t = x * y + 128;
+  return (t + (t >> 8)) >> 8;
+}
+
+template <SDL_BlendMode Mode> inline Uint32 blendChannel(Uint32 s, Uint32 d, Uint32 sa, bool alpha) {
+  const Uint32 inv = 255 - sa;
+  switch (Mode) {
+  case SDL_BLENDMODE_BLEND:
+    return (alpha ? sa : mul255(s, sa)) + mul255(d, inv);
+  case SDL_BLENDMODE_BLEND_PREMULTIPLIED:
+    return s + mul255(d, inv);
+  case SDL_BLENDMODE_ADD:
+    return alpha ? d : d + mul255(s, sa);
+  case SDL_BLENDMODE_ADD_PREMULTIPLIED:
+    return alpha ? d : d + s;
+  case SDL_BLENDMODE_MOD:
+    return alpha ? d : mul255(s, d);
+  case SDL_BLENDMODE_MUL:
+    return alpha ? d : mul255(d, s) + mul255(d, inv);
+  default:
+    return s;
+  }
+}
+
+template <SDL_BlendMode Mode> inline Uint32 blendPixel(Uint32 src, Uint32 dst) {
+  const Uint32 sa = src & 0xFF;
+  Uint32 out = 0;
+  for (int shift = 0; shift < 32; shift += 8) {
+    Uint32 c = blendChannel<Mode>((src >> shift) & 0xFF, (dst >> shift) & 0xFF,
+                                  sa, shift == 0);
+    out |= std::min<Uint32>(c, 255) << shift;
+  }
+  return out;
+}
+
+template <SDL_BlendMode Mode> void fillScalar(Uint32 *dst, int count, Uint32 color) {
+  if (Mode == SDL_BLENDMODE_NONE) {
+    std::fill_n(dst, count, color);
+    return;
+  }
+  for (int i = 0; i < count; i++)
+    dst[i] = blendPixel<Mode>(color, dst[i]);
+}
+
+template <SDL_BlendMode Mode> void blitScalar(Uint32 *dst, const Uint32 *src, int count) {
+  if (Mode == SDL_BLENDMODE_NONE) {
+    std::copy_n(src, count, dst);
+    return;
+  }
+  for (int i = 0; i < count; i++)
+    dst[i] = blendPixel<Mode>(src[i], dst[i]);
+}
+
+#ifdef BGT_PIXEL_KERNELS_X86
+// ------------------------------------------
+// SSE2 版本：每次处理 4 个像素，展开为 16 位通道后运算
+// 小端序下每个像素展开后的 4 个通道依次为 A、B、G、R
+// ------------------------------------------
+
+TARGET_SSE2 inline __m128i mul255(__m128i x, __m128i y) {
+  __m128i t = _mm_add_epi16(_mm_mullo_epi16(x, y), _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+// s、d 为 16 位通道，返回未饱和的结果
+template <SDL_BlendMode Mode> TARGET_SSE2 inline __m128i blend16(__m128i s, __m128i d) {
+  // 每个像素的 A 通道全 1，其余为 0
+  const __m128i alphaMask = _mm_set1_epi64x(0xFFFF);
+  const __m128i alpha255 = _mm_set1_epi64x(0xFF);
+  const __m128i sa = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0), 0);
+  const __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), sa);
+  // 与 A 通道为 255 的向量相乘时 A 通道保持不变；与 A 通道为 0 的向量相乘时 A 通道为 0
+  switch (Mode) {
+  case SDL_BLENDMODE_BLEND:
+    return _mm_add_epi16(mul255(s, _mm_or_si128(_mm_andnot_si128(alphaMask, sa), alpha255)),
+                         mul255(d, inv));
+  case SDL_BLENDMODE_BLEND_PREMULTIPLIED:
+    return _mm_add_epi16(s, mul255(d, inv));
+  case SDL_BLENDMODE_ADD:
+    return _mm_add_epi16(d, mul255(s, _mm_andnot_si128(alphaMask, sa)));
+  case SDL_BLENDMODE_ADD_PREMULTIPLIED:
+    return _mm_add_epi16(d, _mm_andnot_si128(alphaMask, s));
+  case SDL_BLENDMODE_MOD:
+    return mul255(d, _mm_or_si128(_mm_andnot_si128(alphaMask, s), alpha255));
+  case SDL_BLENDMODE_MUL:
+    return _mm_add_epi16(mul255(d, _mm_or_si128(_mm_andnot_si128(alphaMask, s), alpha255)),
+                         mul255(d, _mm_andnot_si128(alphaMask, inv)));
+  default:
+    return s;
+  }
+}
+
+template <SDL_BlendMode Mode> TARGET_SSE2 inline __m128i blend4(__m128i src, __m128i dst) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i lo = blend16<Mode>(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero));
+  __m128i hi = blend16<Mode>(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero));
+  // packus 同时完成了饱和
+  return _mm_packus_epi16(lo, hi);
+}
+
+template <SDL_BlendMode Mode> TARGET_SSE2 void fillSSE2(Uint32 *dst, int count, Uint32 color) {
+  const __m128i src = _mm_set1_epi32(static_cast<int>(color));
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i *p = reinterpret_cast<__m128i *>(dst + i);
+    _mm_storeu_si128(p, Mode == SDL_BLENDMODE_NONE ? src : blend4<Mode>(src, _mm_loadu_si128(p)));
+  }
+  fillScalar<Mode>(dst + i, count - i, color);
+}
+
+template <SDL_BlendMode Mode> TARGET_SSE2 void blitSSE2(Uint32 *dst, const Uint32 *src, int count) {
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i *p = reinterpret_cast<__m128i *>(dst + i);
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm_storeu_si128(p, Mode == SDL_BLENDMODE_NONE ? s : blend4<Mode>(s, _mm_loadu_si128(p)));
+  }
+  blitScalar<Mode>(dst + i, src + i, count - i);
+}
+
+// ------------------------------------------
+// AVX2 版本：与 SSE2 版本相同，每次处理 8 个像素
+// unpack 与 packus 都在 128 位的半边内进行，因此像素顺序不会被打乱
+// ------------------------------------------
+
+TARGET_AVX2 inline __m256i mul255(__m256i x, __m256i y) {
+  __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(x, y), _mm256_set1_epi16(128));
+  return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+template <SDL_BlendMode Mode> TARGET_AVX2 inline __m256i blend16(__m256i s, __m256i d) {
+  const __m256i alphaMask = _mm256_set1_epi64x(0xFFFF);
+  const __m256i alpha255 = _mm256_set1_epi64x(0xFF);
+  const __m256i sa = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0), 0);
+  const __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), sa);
+  switch (Mode) {
+  case SDL_BLENDMODE_BLEND:
+    return _mm256_add_epi16(mul255(s, _mm256_or_si256(_mm256_andnot_si256(alphaMask, sa), alpha255)),
+                            mul255(d, inv));
+  case SDL_BLENDMODE_BLEND_PREMULTIPLIED:
+    return _mm256_add_epi16(s, mul255(d, inv));
+  case SDL_BLENDMODE_ADD:
+    return _mm256_add_epi16(d, mul255(s, _mm256_andnot_si256(alphaMask, sa)));
+  case SDL_BLENDMODE_ADD_PREMULTIPLIED:
+    return _mm256_add_epi16(d, _mm256_andnot_si256(alphaMask, s));
+  case SDL_BLENDMODE_MOD:
+    return mul255(d, _mm256_or_si256(_mm256_andnot_si256(alphaMask, s), alpha255));
+  case SDL_BLENDMODE_MUL:
+    return _mm256_add_epi16(mul255(d, _mm256_or_si256(_mm256_andnot_si256(alphaMask, s), alpha255)),
+                            mul255(d, _mm256_andnot_si256(alphaMask, inv)));
+  default:
+    return s;
+  }
+}
+
+template <SDL_BlendMode Mode> TARGET_AVX2 inline __m256i blend8(__m256i src, __m256i dst) {
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i lo = blend16<Mode>(_mm256_unpacklo_epi8(src, zero), _mm256_unpacklo_epi8(dst, zero));
+  __m256i hi = blend16<Mode>(_mm256_unpackhi_epi8(src, zero), _mm256_unpackhi_epi8(dst, zero));
+  return _mm256_packus_epi16(lo, hi);
+}
+
+template <SDL_BlendMode Mode> TARGET_AVX2 void fillAVX2(Uint32 *dst, int count, Uint32 color) {
+  const __m256i src = _mm256_set1_epi32(static_cast<int>(color));
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i *p = reinterpret_cast<__m256i *>(dst + i);
+    _mm256_storeu_si256(p, Mode == SDL_BLENDMODE_NONE ? src : blend8<Mode>(src, _mm256_loadu_si256(p)));
+  }
+  fillSSE2<Mode>(dst + i, count - i, color);
+}
+
+template <SDL_BlendMode Mode> TARGET_AVX2 void blitAVX2(Uint32 *dst, const Uint32 *src, int count) {
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i *p = reinterpret_cast<__m256i *>(dst + i);
+    __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    _mm256_storeu_si256(p, Mode == SDL_BLENDMODE_NONE ? s : blend8<Mode>(s, _mm256_loadu_si256(p)));
+  }
+  blitSSE2<Mode>(dst + i, src + i, count - i);
+}
+#endif
+
+// ------------------------------------------
+// 按混合模式索引的内核表
+// ------------------------------------------
+
+#define BGT_PIXEL_KERNEL_TABLE(Isa)                                            \
+  {{fill##Isa<SDL_BLENDMODE_NONE>, blit##Isa<SDL_BLENDMODE_NONE>},             \
+   {fill##Isa<SDL_BLENDMODE_BLEND>, blit##Isa<SDL_BLENDMODE_BLEND>},           \
+   {fill##Isa<SDL_BLENDMODE_BLEND_PREMULTIPLIED>,                              \
+    blit##Isa<SDL_BLENDMODE_BLEND_PREMULTIPLIED>},                             \
+   {fill##Isa<SDL_BLENDMODE_ADD>, blit##Isa<SDL_BLENDMODE_ADD>},               \
+   {fill##Isa<SDL_BLENDMODE_ADD_PREMULTIPLIED>,                                \
+    blit##Isa<SDL_BLENDMODE_ADD_PREMULTIPLIED>},                               \
+   {fill##Isa<SDL_BLENDMODE_MOD>, blit##Isa<SDL_BLENDMODE_MOD>},               \
+   {fill##Isa<SDL_BLENDMODE_MUL>, blit##Isa<SDL_BLENDMODE_MUL>}}
+
+constexpr int kModeCount = 7;
+
+const PixelKernels kScalarKernels[kModeCount] = BGT_PIXEL_KERNEL_TABLE(Scalar);
+#ifdef BGT_PIXEL_KERNELS_X86
+const PixelKernels kSSE2Kernels[kModeCount] = BGT_PIXEL_KERNEL_TABLE(SSE2);
+const PixelKernels kAVX2Kernels[kModeCount] = BGT_PIXEL_KERNEL_TABLE(AVX2);
+#endif
+
+#undef BGT_PIXEL_KERNEL_TABLE
+
+int modeIndex(SDL_BlendMode mode) {
+  switch (mode) {
+  case SDL_BLENDMODE_NONE:
+    return 0;
+  case SDL_BLENDMODE_BLEND:
+    return 1;
+  case SDL_BLENDMODE_BLEND_PREMULTIPLIED:
+    return 2;
+  case SDL_BLENDMODE_ADD:
+    return 3;
+  case SDL_BLENDMODE_ADD_PREMULTIPLIED:
+    return 4;
+  case SDL_BLENDMODE_MOD:
+    return 5;
+  case SDL_BLENDMODE_MUL:
+    return 6;
+  default:
+    return -1;
+  }
+}
+} // namespace
+
+PixelIsa bestPixelIsa() {
+  static const PixelIsa isa = [] {
+#ifdef BGT_PIXEL_KERNELS_X86
+    if (SDL_HasAVX2())
+      return PixelIsa::AVX2;
+    if (SDL_HasSSE2())
+      return PixelIsa::SSE2;
+#endif
+    return PixelIsa::Scalar;
+  }();
+  return isa;
+}
+
+const char *pixelIsaName(PixelIsa isa) {
+  switch (isa) {
+  case PixelIsa::AVX2:
+    return "AVX2";
+  case PixelIsa::SSE2:
+    return "SSE2";
+  default:
+    return "scalar";
+  }
+}
+
+const PixelKernels *pixelKernels(SDL_BlendMode mode, PixelIsa isa) {
+  const int index = modeIndex(mode);
+  if (index < 0)
+    return nullptr;
+  // 不允许选择比当前 CPU 支持的更高的指令集
+  if (static_cast<int>(isa) > static_cast<int>(bestPixelIsa()))
+    return nullptr;
+  switch (isa) {
+#ifdef BGT_PIXEL_KERNELS_X86
+  case PixelIsa::AVX2:
+    return &kAVX2Kernels[index];
+  case PixelIsa::SSE2:
+    return &kSSE2Kernels[index];
+#endif
+  default:
+    return &kScalarKernels[index];
+  }
+}
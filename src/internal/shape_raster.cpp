@@ -0,0 +1,80 @@
+#include <internal/shape_raster.h>
+
+#include <cstdint>
+
+namespace {
+// 计算 y = 0..ry 每一行的半宽；随着 y 增大半宽单调不增，
+// 因此从上一行的结果继续往下减即可，总共只需 O(rx + ry) 次比较
+void halfWidths(int rx, int ry, std::vector<int> &widths) {
+  const std::int64_t rx2 = std::int64_t(rx) * rx;
+  const std::int64_t ry2 = std::int64_t(ry) * ry;
+  const std::int64_t limit = rx2 * ry2;
+  widths.resize(ry + 1);
+  int x = rx;
+  for (int y = 0; y <= ry; y++) {
+    while (x > 0 && std::int64_t(x) * x * ry2 + std::int64_t(y) * y * rx2 > limit)
+      x--;
+    widths[y] = x;
+  }
+}
+
+SDL_FRect span(int x, int y, int w, int h) {
+  return {float(x), float(y), float(w), float(h)};
+}
+
+// 复用的缓冲区，避免每次绘制都分配内存
+std::vector<int> s_widths;
+} // namespace
+
+void appendEllipseSpans(int cx, int cy, int rx, int ry,
+                        std::vector<SDL_FRect> &out) {
+  if (rx < 0 || ry < 0)
+    return;
+  std::vector<int> &widths = s_widths;
+  halfWidths(rx, ry, widths);
+
+  for (int y0 = 0; y0 <= ry;) {
+    int y1 = y0;
+    while (y1 < ry && widths[y1 + 1] == widths[y0])
+      y1++;
+    const int x = widths[y0];
+    if (y0 == 0) {
+      // 包含中心行的一段上下对称，合并为一个矩形
+      out.push_back(span(cx - x, cy - y1, 2 * x + 1, 2 * y1 + 1));
+    } else {
+      const int rows = y1 - y0 + 1;
+      out.push_back(span(cx - x, cy - y1, 2 * x + 1, rows));
+      out.push_back(span(cx - x, cy + y0, 2 * x + 1, rows));
+    }
+    y0 = y1 + 1;
+  }
+}
+
+void appendEllipseOutlineSpans(int cx, int cy, int rx, int ry,
+                               std::vector<SDL_FRect> &out) {
+  if (rx < 0 || ry < 0)
+    return;
+  std::vector<int> &widths = s_widths;
+  halfWidths(rx, ry, widths);
+
+  auto widthAt = [&](int y) {
+    y = y < 0 ? -y : y;
+    return y > ry ? -1 : widths[y];
+  };
+
+  for (int y = -ry; y <= ry; y++) {
+    const int x = widthAt(y);
+    // 上下两行中较窄的那一行之外的像素都与外部相邻
+    int inner = widthAt(y - 1);
+    if (widthAt(y + 1) < inner)
+      inner = widthAt(y + 1);
+    // 每行至少保留最外侧的像素
+    const int lo = (inner < x - 1 ? inner : x - 1) + 1;
+    if (lo <= 0) {
+      out.push_back(span(cx - x, cy + y, 2 * x + 1, 1));
+    } else {
+      out.push_back(span(cx - x, cy + y, x - lo + 1, 1));
+      out.push_back(span(cx + lo, cy + y, x - lo + 1, 1));
+    }
+  }
+}
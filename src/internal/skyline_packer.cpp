@@ -0,0 +1,80 @@
+#include <internal/skyline_packer.h>
+
+#include <algorithm>
+#include <climits>
+
+void SkylinePacker::init(int width, int height) {
+  m_width = width;
+  m_height = height;
+  m_skyline.assign(1, {0, 0, width});
+}
+
+int SkylinePacker::fit(std::size_t index, int width, int height) const {
+  const int x = m_skyline[index].x;
+  if (x + width > m_width)
+    return -1;
+  // 矩形跨过的各段轮廓中最高的一段决定了它的位置
+  int y = 0;
+  for (int remaining = width; remaining > 0; index++) {
+    y = std::max(y, m_skyline[index].y);
+    if (y + height > m_height)
+      return -1;
+    remaining -= m_skyline[index].width;
+  }
+  return y;
+}
+
+bool SkylinePacker::insert(int width, int height, int &x, int &y) {
+  if (width <= 0 || height <= 0)
+    return false;
+  int bestTop = INT_MAX, bestWidth = INT_MAX;
+  std::size_t bestIndex = m_skyline.size();
+  for (std::size_t i = 0; i < m_skyline.size(); i++) {
+    const int top = fit(i, width, height);
+    if (top < 0)
+      continue;
+    if (top + height < bestTop ||
+        (top + height == bestTop && m_skyline[i].width < bestWidth)) {
+      bestTop = top + height;
+      bestWidth = m_skyline[i].width;
+      bestIndex = i;
+    }
+  }
+  if (bestIndex == m_skyline.size())
+    return false;
+
+  x = m_skyline[bestIndex].x;
+  y = bestTop - height;
+  place(bestIndex, x, y, width, height);
+  return true;
+}
+
+void SkylinePacker::place(std::size_t index, int x, int y, int width,
+                          int height) {
+  m_skyline.insert(m_skyline.begin() + index, {x, y + height, width});
+
+  // 新矩形下方的轮廓被遮住了，缩短或者删除
+  const int right = x + width;
+  std::size_t next = index + 1;
+  while (next < m_skyline.size() && m_skyline[next].x < right) {
+    Segment &segment = m_skyline[next];
+    const int segmentRight = segment.x + segment.width;
+    if (segmentRight <= right) {
+      m_skyline.erase(m_skyline.begin() + next);
+      continue;
+    }
+    segment.width = segmentRight - right;
+    segment.x = right;
+    break;
+  }
+
+  // 合并高度相同的相邻轮廓
+  for (std::size_t i = 0; i + 1 < m_skyline.size();) {
+    if (m_skyline[i].y == m_skyline[i + 1].y) {
+      m_skyline[i].width += m_skyline[i + 1].width;
+      m_skyline.erase(m_skyline.begin() + i + 1);
+    } else {
+      i++;
+    }
+  }
+}
@@ -0,0 +1,64 @@
+#include <internal/text_cache.h>
+
+namespace {
+// 粗略估算一条缓存的内存占用：TTF_Text 内部按字形保存绘制操作，
+// 这里按每字节 64 字节计算，再加上固定开销
+std::size_t estimateCost(std::string_view utf8) {
+  return 256 + utf8.size() * 65;
+}
+} // namespace
+
+TTF_Text *TextCache::acquire(TTF_TextEngine *engine, TTF_Font *font,
+                             std::string_view utf8, int *width) {
+  if (auto it = m_index.find(KeyView{font, utf8}); it != m_index.end()) {
+    ++m_hits;
+    // 移动到表头，节点本身不变，索引仍然有效
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    if (width)
+      *width = it->second->width;
+    return it->second->text;
+  }
+
+  ++m_misses;
+  // SDL_ttf 中长度为 0 表示以 '\0' 结尾，空串需要传入真正的空字符串
+  const char *data = utf8.empty() ? "" : utf8.data();
+  auto *text = TTF_CreateText(engine, font, data, utf8.size());
+  if (!text)
+    return nullptr;
+
+  int measured = 0;
+  TTF_MeasureString(font, data, utf8.size(), 0, &measured, nullptr);
+
+  // 先腾出空间再插入，保证刚创建的条目在下一次 acquire 之前不会被淘汰
+  std::size_t cost = estimateCost(utf8);
+  evictUntil(m_budget > cost ? m_budget - cost : 0);
+
+  m_lru.push_front(Entry{font, std::string(utf8), text, measured, cost});
+  m_index.emplace(KeyView{font, m_lru.front().utf8}, m_lru.begin());
+  m_bytes += cost;
+
+  if (width)
+    *width = measured;
+  return text;
+}
+
+void TextCache::setBudget(std::size_t bytes) {
+  m_budget = bytes;
+  evictUntil(bytes);
+}
+
+void TextCache::evictUntil(std::size_t budget) {
+  while (!m_lru.empty() && m_bytes > budget) {
+    Entry &victim = m_lru.back();
+    m_index.erase(KeyView{victim.font, victim.utf8});
+    TTF_DestroyText(victim.text);
+    m_bytes -= victim.cost;
+    m_lru.pop_back();
+  }
+}
+
+void TextCache::clear() {
+  evictUntil(0);
+  m_hits = 0;
+  m_misses = 0;
+}
@@ -0,0 +1,117 @@
+#include <internal/trace_recorder.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_timer.h>
+
+namespace {
+struct Event {
+  const char *name;
+  const char *category;
+  Uint64 start;
+  Uint64 end;
+  Uint64 threadId;
+};
+
+// 名称都是库内部的字面量，这里只做最基本的转义
+void appendJsonString(std::string &out, const char *str) {
+  out.push_back('"');
+  for (; *str; str++) {
+    if (*str == '"' || *str == '\\')
+      out.push_back('\\');
+    out.push_back(*str);
+  }
+  out.push_back('"');
+}
+} // namespace
+
+void TraceRecorder::start(std::size_t capacity) {
+  stop();
+  std::size_t size = 1;
+  while (size < capacity)
+    size *= 2;
+  if (size != m_mask + 1 || !m_slots) {
+    m_slots = std::make_unique<Slot[]>(size);
+    m_mask = size - 1;
+  } else {
+    for (std::size_t i = 0; i < size; i++)
+      m_slots[i].sequence.store(0, std::memory_order_relaxed);
+  }
+  m_next.store(0, std::memory_order_relaxed);
+  m_enabled.store(true, std::memory_order_release);
+}
+
+void TraceRecorder::record(const char *name, const char *category,
+                           Uint64 start, Uint64 end) {
+  if (!enabled())
+    return;
+  const Uint64 index = m_next.fetch_add(1, std::memory_order_relaxed);
+  Slot &slot = m_slots[index & m_mask];
+  // 序号为 0 表示正在写入；写完后存入 index + 1，导出时据此判断内容是否完整
+  slot.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.name = name;
+  slot.category = category;
+  slot.start = start;
+  slot.end = end;
+  slot.threadId = SDL_GetCurrentThreadID();
+  slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+bool TraceRecorder::writeChromeTrace(const char *utf8Path) const {
+  std::vector<Event> events;
+  if (m_slots) {
+    const Uint64 next = m_next.load(std::memory_order_acquire);
+    const Uint64 count = std::min<Uint64>(next, m_mask + 1);
+    events.reserve(count);
+    for (Uint64 index = next - count; index < next; index++) {
+      const Slot &slot = m_slots[index & m_mask];
+      if (slot.sequence.load(std::memory_order_acquire) != index + 1)
+        continue;
+      Event event{slot.name, slot.category, slot.start, slot.end,
+                  slot.threadId};
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) == index + 1)
+        events.push_back(event);
+    }
+  }
+  // 嵌套的事件结束得早，记录的顺序与开始时间不一致；查看工具要求同一线程内按开始时间排列
+  std::ranges::stable_sort(events, {}, &Event::start);
+
+  const double usPerTick = 1e6 / double(SDL_GetPerformanceFrequency());
+  const Uint64 origin = events.empty() ? 0 : events.front().start;
+  std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  char number[96];
+  for (std::size_t i = 0; i < events.size(); i++) {
+    const Event &event = events[i];
+    json += "{\"name\":";
+    appendJsonString(json, event.name);
+    json += ",\"cat\":";
+    appendJsonString(json, event.category);
+    SDL_snprintf(number, sizeof(number),
+                 ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%llu}",
+                 double(event.start - origin) * usPerTick,
+                 double(event.end - event.start) * usPerTick,
+                 static_cast<unsigned long long>(event.threadId));
+    json += number;
+    json += i + 1 < events.size() ? ",\n" : "\n";
+  }
+  json += "]}\n";
+
+  SDL_IOStream *io = SDL_IOFromFile(utf8Path, "wb");
+  if (!io)
+    return false;
+  const bool written = SDL_WriteIO(io, json.data(), json.size()) == json.size();
+  return SDL_CloseIO(io) && written;
+}
+
+void TraceRecorder::reset() {
+  stop();
+  m_slots.reset();
+  m_mask = 0;
+  m_next.store(0, std::memory_order_relaxed);
+}
@@ -1,10 +1,31 @@
 #include <iostream>
 #include <utility> // for std::move
 #include <string>
+#include <vector>
+#include <deque>
+#include <array>
+#include <memory>
+#include <cstdlib> // for std::abs
+#include <cstring> // for std::strlen
+#include <climits> // for INT_MAX
 #include <algorithm> // for std::ranges::all_of
 
 #include <libbgt.h>
+#include <internal/call_recorder.h>
+#include <internal/dirty_region.h>
+#include <internal/draw_batch.h>
+#include <internal/font_metrics.h>
+#include <internal/frame_profiler.h>
 #include <internal/font_utils.h>
+#include <internal/glyph_atlas.h>
+#include <internal/image_cache.h>
+#include <internal/image_reader.h>
+#include <internal/image_utils.h>
+#include <internal/image_writer.h>
+#include <internal/pixel_kernels.h>
+#include <internal/shape_raster.h>
+#include <internal/text_cache.h>
+#include <internal/trace_recorder.h>
 
 #include <SDL3/SDL_events.h>
 #include <SDL3/SDL_log.h>
@@ -12,6 +33,7 @@
 #include <SDL3/SDL_render.h>
 #include <SDL3/SDL_video.h>
 #include <SDL3/SDL_keyboard.h>
+#include <SDL3/SDL_mouse.h>
 #include <SDL3_ttf/SDL_ttf.h>
 #ifdef USE_ANSI
 #include <windows.h> // For Windows code page conversion
@@ -29,12 +51,113 @@ namespace {
 	SDL_Texture* render_target = nullptr;
 	TTF_Font* font = nullptr;
 	TTF_TextEngine* text_engine = nullptr;
+	TextCache text_cache;
+	// 只有等宽字体才启用字形图集，见 bgt_init
+	GlyphAtlas glyph_atlas;
+	FontMetrics font_metrics;
+
+	// 批量绘制状态，见 bgt_begin_batch
+	DrawBatch draw_batch;
+	int batch_depth = 0;
+	bool batch_flush_pending = false;
+
+	// 显示调度状态，见 bgt_set_frame_rate
+	// present_interval_ns 为 0 表示每次刷新请求都立即显示
+	Uint64 present_interval_ns = 0;
+	bool present_on_idle = false;
+	bool present_pending = false;
+	Uint64 last_present_ns = 0;
+
+	// 脏矩形记录：只把上次显示以来画过的区域拷贝到窗口上
+	// 只有软件渲染器直接在窗口表面上绘制、内容在两次显示之间保持不变，才能局部更新
+	int canvas_width = 0, canvas_height = 0;
+	DirtyRegion dirty_region;
+	bool partial_present_supported = false;
+	unsigned long long present_count = 0;
+	unsigned long long pixels_pushed = 0;
+
+	// 离屏图层，见 bgt_create_layer；图层编号为下标加 1，销毁后的位置留空，供之后创建的图层复用
+	std::vector<SDL_Texture*> layers;
+	int draw_layer = BGT_CANVAS;
+
+	// bgt_load_image 加载的图片
+	ImageCache image_cache;
+
+	// 等待期间从 SDL 队列中取出的事件暂存在这里，之后的读取函数会先从这里按原顺序取
+	std::deque<SDL_Event> held_events;
+	constexpr std::size_t MAX_HELD_EVENTS = 65536;
+
+	// 直接访问像素，见 bgt_lock_pixels
+	// pixel_shadow 是画布在内存中的副本，pixel_upload 用于把它传回 render_target
+	SDL_Surface* pixel_shadow = nullptr;
+	SDL_Texture* pixel_upload = nullptr;
+	bool pixels_locked = false;
+	// 每次在画布上绘制都会递增 canvas_generation；二者相等说明副本仍与画布一致，无需读回
+	Uint64 canvas_generation = 0;
+	Uint64 shadow_generation = UINT64_MAX;
+	// 最近一次 bgt_set_blend_mode 设置的模式，bgt_pixels_* 系列函数据此选择混合内核
+	SDL_BlendMode current_blend_mode = SDL_BLENDMODE_BLEND;
+
+	// 无窗口模式，见 bgt_init_headless；此时渲染器直接画在内存中的 headless_surface 上
+	bool headless = false;
+	SDL_Surface* headless_surface = nullptr;
+
+	// bgt_init 使用的渲染器，见 bgt_set_renderer；空字符串表示由 SDL 自动选择
+	std::string requested_renderer = SDL_SOFTWARE_RENDERER;
+
+	// 性能统计，见 bgt_get_frame_stats；浮层在窗口上占据的区域，下次刷新时需要先用画布的内容盖住
+	FrameProfiler profiler;
+	bool profiler_overlay = false;
+	SDL_Rect overlay_rect = {};
+
+	// 活动记录，见 bgt_start_trace；trace_path 为 bgt_quit 时写出的文件
+	TraceRecorder tracer;
+	std::string trace_path;
+
+	// 调用录制，见 bgt_start_recording
+	// 绘制函数之间会互相调用（例如 bgt_input_ascii 内部调用 bgt_show_str），只录制最外层的调用
+	CallWriter call_writer;
+	int record_depth = 0;
+
+	class RecordGuard {
+	public:
+		explicit RecordGuard(CallOp op) : active(call_writer.isOpen() && record_depth == 0) {
+			record_depth++;
+			if (active) {
+				call_writer.beginCall(op);
+			}
+		}
+		~RecordGuard() {
+			record_depth--;
+		}
+		RecordGuard(const RecordGuard&) = delete;
+		RecordGuard& operator=(const RecordGuard&) = delete;
+		explicit operator bool() const {
+			return active;
+		}
+	private:
+		bool active;
+	};
+
+	// 不绘制任何东西的输入函数在读到输入之后才记录，没有读到输入时不产生记录
+	void record_input(CallOp op, std::initializer_list<int> values) {
+		if (call_writer.isOpen()) {
+			call_writer.beginCall(op);
+			call_writer.putInts(values);
+		}
+	}
+
+	// 输入状态快照，见 bgt_update_input_state
+	// 保存上一帧与这一帧的状态，两者比较即可得到“刚按下”与“刚松开”
+	std::array<bool, SDL_SCANCODE_COUNT> keys_now{}, keys_prev{};
+	SDL_MouseButtonFlags mouse_buttons_now = 0, mouse_buttons_prev = 0;
+	float snapshot_mouse_x = 0, snapshot_mouse_y = 0;
 #ifdef USE_ANSI
 	std::string localized_error_msg;
 
-	// 将 ANSI 编码转换为 UTF-8 编码
-	std::string ansi_to_utf8(std::string_view str) {
-		std::string result;
+	// 将 ANSI 编码转换为 UTF-8 编码，结果写入 result
+	// result 的容量会被复用，传入同一个缓冲区反复转换时不会再分配内存
+	void ansi_to_utf8(std::string_view str, std::string& result) {
 		// 首先使用 UTF-16, 即 Windows API 中的 WideChar 进行中转
 		// len_required 为缓冲区所需要的字符数, 注意, 由于输入为 string_view, 传入的长度不包含 '\0', 故 len_required 也未计算 '\0'
 		int len_required = MultiByteToWideChar(CP_ACP, 0, str.data(), static_cast<int>(str.length()), nullptr, 0);
@@ -57,6 +180,11 @@ namespace {
 					buf, len_required, nullptr, nullptr);
 				return len_required - 1;
 			});
+	}
+
+	std::string ansi_to_utf8(std::string_view str) {
+		std::string result;
+		ansi_to_utf8(str, result);
 		return result;
 	}
 
@@ -93,6 +221,384 @@ namespace {
 		Uint8 r, g, b, a;
 	};
 
+	// 绘制函数的目标：当前选中的图层，或者画布
+	SDL_Texture* draw_target() {
+		return draw_layer == BGT_CANVAS ? render_target : layers[draw_layer - 1];
+	}
+
+	SDL_Texture* find_layer(int layer) {
+		if (layer < 1 || layer > static_cast<int>(layers.size()) || !layers[layer - 1]) {
+			SDL_SetError("Invalid layer: %d", layer);
+			return nullptr;
+		}
+		return layers[layer - 1];
+	}
+
+	// 记录画布上被修改的区域，向外多扩 1 像素，避免缩放显示时边缘采样不完整
+	// 画在图层上的内容要等合成时才会出现在画布上
+	void mark_dirty(int x, int y, int w, int h) {
+		if (draw_layer != BGT_CANVAS) {
+			return;
+		}
+		// 先把负的宽高转为正的，否则向外扩的 1 像素反而会把区域缩小
+		if (w < 0) {
+			x += w;
+			w = -w;
+		}
+		if (h < 0) {
+			y += h;
+			h = -h;
+		}
+		dirty_region.add({ x - 1, y - 1, w + 2, h + 2 });
+		canvas_generation++;
+	}
+
+	SDL_Color to_color(int r, int g, int b, int a) {
+		return SDL_Color{ static_cast<Uint8>(r), static_cast<Uint8>(g), static_cast<Uint8>(b), static_cast<Uint8>(a) };
+	}
+
+	// 在渲染目标上绘制一段已排版的文本，颜色在绘制时才设置，调用者负责设置渲染目标
+	bool draw_text(TTF_Text* text, float x, float y, SDL_Color color) {
+		return TTF_SetTextColor(text, color.r, color.g, color.b, color.a) &&
+			TTF_DrawRendererText(text, x, y);
+	}
+
+	// 从缓存取出排版好的文本；未命中时的排版（包括查找后备字体）单独计时
+	TTF_Text* acquire_text(const char* utf8_str, int* width) {
+		const auto misses = text_cache.misses();
+		const bool timed = profiler.enabled() || tracer.enabled();
+		const Uint64 start = timed ? SDL_GetPerformanceCounter() : 0;
+		auto* text = text_cache.acquire(text_engine, font, utf8_str, width);
+		if (timed && text_cache.misses() != misses) {
+			const Uint64 end = SDL_GetPerformanceCounter();
+			profiler.moveToZone(FrameProfiler::TextShaping, end - start);
+			// 排版新的文字可能要加载后备字体，是帧时间突增的常见原因
+			tracer.record("text_shaping", "text", start, end);
+		}
+		return text;
+	}
+
+	bool draw_utf8_text(float x, float y, const char* utf8_str, SDL_Color color) {
+		if (glyph_atlas.enabled() && glyph_atlas.draw(utf8_str, x, y, color)) {
+			return true;
+		}
+		auto* text = acquire_text(utf8_str, nullptr);
+		return text && draw_text(text, x, y, color);
+	}
+
+	// 把批量模式下积累的命令一次性画到 render_target 上
+	bool submit_batch() {
+		if (draw_batch.empty()) {
+			return true;
+		}
+		FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Draw);
+		TraceRecorder::Scope trace_scope(tracer, "submit_batch", "draw");
+		RenderDrawColorGuard _;
+		SDL_SetRenderTarget(renderer, draw_target());
+		return draw_batch.submit(renderer, draw_utf8_text);
+	}
+
+	// 绘制函数的收尾：按需刷新屏幕。批量模式下刷新请求被推迟到 bgt_end_batch
+	bool finish_draw(bool flush) {
+		if (!flush) {
+			return true;
+		}
+		if (batch_depth > 0) {
+			batch_flush_pending = true;
+			return true;
+		}
+		return bgt_flush();
+	}
+
+	// 在作用域内暂停批量模式，用于 bgt_input 这类需要立即看到绘制结果的交互函数
+	struct BatchSuspendGuard {
+		BatchSuspendGuard() : saved_depth(batch_depth) {
+			if (saved_depth > 0) {
+				submit_batch();
+				batch_depth = 0;
+			}
+		}
+		~BatchSuspendGuard() {
+			batch_depth = saved_depth;
+		}
+		int saved_depth;
+	};
+
+	// 在窗口的右上角绘制性能浮层，直接画在窗口上而不是画布上，因此不会影响画布的内容
+	bool draw_profiler_overlay() {
+		const auto& frame = profiler.lastFrame();
+		const auto lookups = frame.cacheHits + frame.cacheMisses;
+		char lines[4][96];
+		SDL_snprintf(lines[0], sizeof(lines[0]), "FPS %.1f  frame %.2f ms", profiler.fps(), frame.frameMs);
+		SDL_snprintf(lines[1], sizeof(lines[1]), "draw %.2f  text %.2f+%.2f ms",
+			frame.zoneMs[FrameProfiler::Draw], frame.zoneMs[FrameProfiler::Text], frame.zoneMs[FrameProfiler::TextShaping]);
+		SDL_snprintf(lines[2], sizeof(lines[2]), "present %.2f  events %.2f ms",
+			frame.zoneMs[FrameProfiler::Present], frame.zoneMs[FrameProfiler::Events]);
+		SDL_snprintf(lines[3], sizeof(lines[3]), "calls %llu  px %llu  cache %d%%",
+			frame.drawCalls, frame.pixels, lookups ? int(frame.cacheHits * 100 / lookups) : 100);
+
+		constexpr int PADDING = 4;
+		constexpr int GRAPH_HEIGHT = 40;
+		// 柱状图的满刻度为 30 FPS 对应的帧时长
+		constexpr float GRAPH_MAX_MS = 1000.0F / 30;
+		const int line_height = font_metrics.height();
+		int width = static_cast<int>(FrameProfiler::kHistorySize);
+		for (const auto& line : lines) {
+			width = std::max(width, font_metrics.measure(line));
+		}
+		width += 2 * PADDING;
+		const int height = 4 * line_height + GRAPH_HEIGHT + 3 * PADDING;
+		const int left = std::max(0, canvas_width - width);
+		overlay_rect = { left, 0, width, height };
+
+		RenderDrawColorGuard _;
+		SDL_BlendMode blend_mode;
+		SDL_GetRenderDrawBlendMode(renderer, &blend_mode);
+		SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+		const SDL_FRect background = { float(left), 0, float(width), float(height) };
+		bool ok = SDL_SetRenderDrawColor(renderer, 0, 0, 0, 192) && SDL_RenderFillRect(renderer, &background);
+		for (int i = 0; i < 4; i++) {
+			ok = draw_utf8_text(float(left + PADDING), float(PADDING + i * line_height), lines[i],
+				SDL_Color{ 255, 255, 0, BGT_ALPHA_OPAQUE }) && ok;
+		}
+
+		// 帧时长柱状图：绿色不超过 60 FPS 的帧时长，黄色不超过 30 FPS，红色更慢
+		static std::vector<SDL_FRect> bars[3];
+		for (auto& group : bars) {
+			group.clear();
+		}
+		const float baseline = float(height - PADDING);
+		for (std::size_t i = 0; i < profiler.historySize(); i++) {
+			const float ms = profiler.historyAt(i);
+			const float bar = std::min(ms / GRAPH_MAX_MS, 1.0F) * GRAPH_HEIGHT;
+			const int group = ms <= 1000.0F / 60 ? 0 : ms <= GRAPH_MAX_MS ? 1 : 2;
+			bars[group].push_back({ float(left + PADDING) + float(i), baseline - bar, 1, bar });
+		}
+		const SDL_Color bar_colors[3] = { { 0, 255, 0, 255 }, { 255, 255, 0, 255 }, { 255, 0, 0, 255 } };
+		for (int group = 0; group < 3; group++) {
+			if (!bars[group].empty()) {
+				const auto& color = bar_colors[group];
+				ok = SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a) &&
+					SDL_RenderFillRects(renderer, bars[group].data(), static_cast<int>(bars[group].size())) && ok;
+			}
+		}
+		SDL_SetRenderDrawBlendMode(renderer, blend_mode);
+		return ok;
+	}
+
+	// 真正把 render_target 显示到窗口上
+	bool present_frame() {
+		FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Present);
+		TraceRecorder::Scope trace_scope(tracer, "present_frame", "present");
+		// 批量模式下 mark_dirty 在记录命令时就已调用，显示之前必须先把积累的命令画到画布上，
+		// 否则脏区域会在像素真正画上去之前被清空
+		const bool submitted = submit_batch();
+		// 如果一直不处理事件或者睡太久，窗口会假死
+		// 为了向新手使用者隔离事件机制，每次刷新的时候顺便从系统收取一下事件
+		// 事件留在队列里不被消费，窗口事件的处理由 bgt_init 中注册的回调完成
+		{
+			FrameProfiler::Scope events_scope(profiler, FrameProfiler::Events);
+			SDL_PumpEvents();
+		}
+		present_pending = false;
+		last_present_ns = SDL_GetTicksNS();
+
+		// 无窗口模式下没有地方可以显示，画布本身就是结果
+		if (headless) {
+			dirty_region.clear();
+			profiler.endFrame(pixels_pushed, text_cache.hits(), text_cache.misses());
+			return submitted;
+		}
+
+		// 自上次显示以来什么都没画，窗口上的内容仍然是对的
+		// 这样的空闲帧照样计入统计，否则平均帧时长偏大；显示浮层时仍要更新浮层
+		if (dirty_region.empty() && !profiler_overlay) {
+			profiler.endFrame(pixels_pushed, text_cache.hits(), text_cache.misses());
+			return submitted;
+		}
+
+		// 上次绘制的浮层可能比这次的大，先用画布盖住
+		if (profiler_overlay && overlay_rect.w > 0) {
+			dirty_region.add(overlay_rect);
+		}
+		bool ok = SDL_SetRenderTarget(renderer, nullptr);
+		if (!partial_present_supported || dirty_region.isFull()) {
+			ok = ok && SDL_RenderClear(renderer) &&
+				SDL_RenderTexture(renderer, render_target, nullptr, nullptr);
+			pixels_pushed += static_cast<unsigned long long>(canvas_width) * canvas_height;
+		}
+		else {
+			for (const auto& rect : dirty_region.rects()) {
+				const SDL_FRect area = { float(rect.x), float(rect.y), float(rect.w), float(rect.h) };
+				ok = SDL_RenderTexture(renderer, render_target, &area, &area) && ok;
+				pixels_pushed += static_cast<unsigned long long>(rect.w) * rect.h;
+			}
+		}
+		dirty_region.clear();
+		present_count++;
+
+		profiler.endFrame(pixels_pushed, text_cache.hits(), text_cache.misses());
+		if (profiler_overlay) {
+			ok = draw_profiler_overlay() && ok;
+			// 浮层自身的文字不计入下一帧的文本缓存统计
+			profiler.rebase(pixels_pushed, text_cache.hits(), text_cache.misses());
+		}
+		TraceRecorder::Scope present_scope(tracer, "SDL_RenderPresent", "present");
+		return SDL_RenderPresent(renderer) && ok && submitted;
+	}
+
+	// 距离上一次显示已经超过一个帧间隔，可以再显示一次了
+	bool present_due() {
+		return !present_on_idle && SDL_GetTicksNS() - last_present_ns >= present_interval_ns;
+	}
+
+	// 在可能阻塞的调用之前保证“画了就能看到”：把被推迟的显示补上
+	bool ensure_presented() {
+		if (!present_pending || !renderer || !render_target) {
+			return true;
+		}
+		return present_frame();
+	}
+
+	// 等待期间窗口发生变化时（见 bgt_init 中的事件回调）补上显示，批量模式的一帧没画完时不显示
+	void present_window_changes() {
+		if (batch_depth == 0) {
+			ensure_presented();
+		}
+	}
+
+	// 暂存一个在等待期间收到的事件，连续的鼠标移动只保留最新位置
+	void hold_event(const SDL_Event& e) {
+		if (e.type == SDL_EVENT_MOUSE_MOTION && !held_events.empty() &&
+			held_events.back().type == SDL_EVENT_MOUSE_MOTION) {
+			auto& last = held_events.back().motion;
+			float xrel = last.xrel + e.motion.xrel, yrel = last.yrel + e.motion.yrel;
+			last = e.motion;
+			last.xrel = xrel;
+			last.yrel = yrel;
+			return;
+		}
+		if (held_events.size() >= MAX_HELD_EVENTS) {
+			held_events.pop_front();
+		}
+		held_events.push_back(e);
+	}
+
+	// 所有读取事件的函数都通过这两个函数取事件，保证暂存的事件先被取出
+	bool poll_event(SDL_Event* e) {
+		if (!held_events.empty()) {
+			*e = held_events.front();
+			held_events.pop_front();
+			return true;
+		}
+		FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Events);
+		return SDL_PollEvent(e);
+	}
+
+	// timeout_ms 为 -1 表示一直等待
+	bool wait_event(SDL_Event* e, Sint32 timeout_ms) {
+		if (!held_events.empty()) {
+			return poll_event(e);
+		}
+		present_window_changes();
+		// 无窗口模式下不会有新的输入，只取出程序自己用 SDL_PushEvent 放入的事件，绝不阻塞
+		return SDL_WaitEventTimeout(e, headless ? 0 : timeout_ms);
+	}
+
+	bool has_pending_events() {
+		return !held_events.empty() || SDL_HasEvents(SDL_EVENT_FIRST, SDL_EVENT_LAST);
+	}
+
+	// 把 SDL 事件转换为 bgt 的事件描述，返回事件类型；不关心的事件返回 BGT_NO_EVENT，out 不变
+	int translate_event(SDL_Event& e, BGT_Event& out) {
+		SDL_ConvertEventToRenderCoordinates(renderer, &e);
+		switch (e.type) {
+		case SDL_EVENT_KEY_UP:
+			out.keycode = e.key.key;
+			out.key_modifier = e.key.mod;
+			out.mouse_action = MOUSE_NO_ACTION;
+			return out.type = BGT_KEYBOARD_EVENT;
+		case SDL_EVENT_MOUSE_BUTTON_DOWN:
+			out.mouse_x = static_cast<int>(e.button.x);
+			out.mouse_y = static_cast<int>(e.button.y);
+			// 鼠标左键
+			if (e.button.button == SDL_BUTTON_LEFT) {
+				if (e.button.clicks == 1) {
+					out.mouse_action = MOUSE_LEFT_BUTTON_CLICK;
+				}
+				else {
+					// 暂时把多次点击视为双击
+					out.mouse_action = MOUSE_LEFT_BUTTON_DOUBLE_CLICK;
+				}
+			}
+			else if (e.button.button == SDL_BUTTON_MIDDLE) {
+				out.mouse_action = MOUSE_WHEEL_CLICK;
+			}
+			else {
+				// 暂时把鼠标侧键当成右键
+				if (e.button.clicks == 1) {
+					out.mouse_action = MOUSE_RIGHT_BUTTON_CLICK;
+				}
+				else {
+					out.mouse_action = MOUSE_RIGHT_BUTTON_DOUBLE_CLICK;
+				}
+			}
+			return out.type = BGT_MOUSE_EVENT;
+		case SDL_EVENT_MOUSE_WHEEL:
+			out.mouse_x = static_cast<int>(e.wheel.mouse_x);
+			out.mouse_y = static_cast<int>(e.wheel.mouse_y);
+			if (e.wheel.y > 0) {
+				out.mouse_action = MOUSE_WHEEL_MOVED_UP;
+			}
+			else {
+				out.mouse_action = MOUSE_WHEEL_MOVED_DOWN;
+			}
+			return out.type = BGT_MOUSE_EVENT;
+		case SDL_EVENT_MOUSE_MOTION:
+			out.mouse_x = static_cast<int>(e.motion.x);
+			out.mouse_y = static_cast<int>(e.motion.y);
+			out.mouse_action = MOUSE_ONLY_MOVED;
+			return out.type = BGT_MOUSE_EVENT;
+		default:
+			return BGT_NO_EVENT;
+		}
+	}
+
+	// 游戏循环通常不会主动等待，读取输入时顺便把到期的显示请求补上
+	// BGT_FRAME_RATE_ON_IDLE 模式下，没有待处理的事件即视为空闲
+	void present_if_idle_or_due() {
+		if (present_pending && (present_due() || (present_on_idle && !has_pending_events()))) {
+			present_frame();
+		}
+	}
+
+	// 等待到指定时刻 (SDL_GetTicksNS)，期间有输入到来时立即醒来收取事件，保持窗口响应
+	// SDL_WaitEventTimeout 只有毫秒精度，最后一小段改用精确延时，保证准时醒来
+	void wait_until(Uint64 deadline_ns) {
+		constexpr Uint64 PRECISE_TAIL_NS = 2 * SDL_NS_PER_MS;
+		// 无窗口模式下以最快速度运行，延时没有意义
+		if (headless) {
+			return;
+		}
+		while (true) {
+			Uint64 now = SDL_GetTicksNS();
+			if (now >= deadline_ns) {
+				return;
+			}
+			Uint64 remaining = deadline_ns - now;
+			if (remaining <= PRECISE_TAIL_NS) {
+				SDL_DelayPrecise(remaining);
+				return;
+			}
+			SDL_Event e;
+			auto timeout_ms = static_cast<Sint32>(SDL_NS_TO_MS(remaining - PRECISE_TAIL_NS));
+			if (SDL_WaitEventTimeout(&e, timeout_ms > 0 ? timeout_ms : 1)) {
+				hold_event(e);
+			}
+			present_window_changes();
+		}
+	}
+
 
 	/*
 	* @brief 将小键盘键码转换为对应的常规键码
@@ -224,90 +730,138 @@ namespace {
 		};
 
 	template<InputValidator Validator = decltype(default_validator), InputParser Parser = decltype(default_parser)>
-	auto bgt_input(int x, int y, SDL_Color bg_color, SDL_Color fg_color, int max_len,
+	// erased 返回结束时用背景色擦除的区域，录制时记下它，回放时据此重现对画布的修改
+	auto bgt_input(int x, int y, SDL_Color bg_color, SDL_Color fg_color, int max_len, SDL_Rect& erased,
 		Validator validator = default_validator, Parser parser = default_parser)
 		-> std::invoke_result_t<Parser, std::string_view> {
-		bool input_complete = false;
+		BatchSuspendGuard batch_guard;
 
 		// TODO: 支持自定义 cursor_height
-		int cursor_x = x, cursor_y = y;
 		const int cursor_width = bgt_get_font_width(), cursor_height = 4;
-
-		auto start_tick = SDL_GetTicks();
+		const int line_height = bgt_get_font_height();
+		// 光标每秒闪烁一次
+		constexpr Uint64 CURSOR_BLINK_MS = 500;
 
 		std::string input_buf;
-		const int line_height = bgt_get_font_height();
 		int cursor_pos = 0;
 
-		int text_width = 0;
-
-		while (true) {
-			// 渲染已输入部分文本与光标
-			auto current_tick = SDL_GetTicks();
-
-			int width_before_cursor = bgt_measure_text(input_buf.substr(0, cursor_pos).c_str());
-			int blank_rect_width = cursor_width + text_width;
+		// prefix_widths[i] 为前 i 个字符的显示宽度，编辑时只重新测量修改位置之后的部分
+		std::vector<int> prefix_widths{ 0 };
+		auto update_prefix_widths = [&](int from) {
+			prefix_widths.resize(input_buf.length() + 1);
+			for (int i = from + 1; i <= static_cast<int>(input_buf.length()); i++) {
+				prefix_widths[i] = bgt_measure_text(input_buf.data(), i);
+			}
+		};
 
+		// 上一次绘制占用的宽度，删除字符后需要把多出来的部分也擦掉
+		int drawn_width = 0;
+		auto draw_cursor = [&](bool visible) {
+			auto& cursor_color = visible ? fg_color : bg_color;
+			bgt_rectangle(x + prefix_widths[cursor_pos], y + line_height - cursor_height, cursor_width, cursor_height,
+				cursor_color.r, cursor_color.g, cursor_color.b, cursor_color.a);
+		};
+		auto draw_all = [&](bool cursor_visible) {
+			int text_width = prefix_widths.back();
 			// 用背景色擦除输入区域
-			bgt_rectangle(x, y, blank_rect_width, line_height, bg_color.r, bg_color.g, bg_color.b, bg_color.a, false);
+			bgt_rectangle(x, y, std::max(drawn_width, text_width + cursor_width), line_height,
+				bg_color.r, bg_color.g, bg_color.b, bg_color.a, false);
 			// 渲染已输入文本
 			bgt_show_str(x, y, input_buf.c_str(), fg_color.r, fg_color.g, fg_color.b, fg_color.a, false);
-			// 光标每秒闪烁一次
-			auto& cursor_color = (current_tick - start_tick) / 500 % 2 ? bg_color : fg_color;
-			bgt_rectangle(x + width_before_cursor, y + line_height - cursor_height, cursor_width, cursor_height,
-				cursor_color.r, cursor_color.g, cursor_color.b, cursor_color.a);
+			draw_cursor(cursor_visible);
+			drawn_width = text_width + cursor_width;
+		};
+
+		auto start_tick = SDL_GetTicks();
+		bool content_changed = true;
+		bool cursor_shown = false;
+
+		while (true) {
+			// 只在内容变化或者光标需要闪烁时重绘
+			auto current_tick = SDL_GetTicks();
+			bool cursor_visible = (current_tick - start_tick) / CURSOR_BLINK_MS % 2 == 0;
+			if (content_changed) {
+				draw_all(cursor_visible);
+			}
+			else if (cursor_visible != cursor_shown) {
+				draw_cursor(cursor_visible);
+			}
+			content_changed = false;
+			cursor_shown = cursor_visible;
+			ensure_presented();
 
+			// 阻塞等待事件，最多等到下一次光标闪烁
+			auto next_blink_tick = start_tick + ((current_tick - start_tick) / CURSOR_BLINK_MS + 1) * CURSOR_BLINK_MS;
 			SDL_Event e;
-			while (SDL_PollEvent(&e)) {
-				switch (e.type) {
-				case SDL_EVENT_KEY_UP:
-					auto keycode =
-						SDL_ConvertNumpadKeycode(
-							SDL_GetKeyFromScancode(e.key.scancode, e.key.mod, false),
-							e.key.mod & SDL_KMOD_NUM
-						);
-					if (keycode == SDLK_RETURN) {
-						// 用背景色擦除输入区域
-						bgt_rectangle(x, y, blank_rect_width, line_height, bg_color.r, bg_color.g, bg_color.b, bg_color.a);
-						return parser(input_buf);
-					}
-					else if (keycode == SDLK_BACKSPACE) {
-						// 按了退格，删除一个字符
-						if (cursor_pos > 0) {
-							SDL_assert(cursor_pos <= static_cast<int>(input_buf.length()));
-							input_buf.erase(cursor_pos - 1, 1);
-							cursor_pos--;
-						}
+			if (!wait_event(&e, static_cast<Sint32>(next_blink_tick - current_tick))) {
+				// 无窗口模式下输入已经耗尽，视为按下回车
+				if (headless) {
+					erased = { x, y, std::max(drawn_width, prefix_widths.back() + cursor_width), line_height };
+					bgt_rectangle(erased.x, erased.y, erased.w, erased.h, bg_color.r, bg_color.g, bg_color.b, bg_color.a);
+					return parser(input_buf);
+				}
+				continue;
+			}
+
+			do {
+				if (e.type != SDL_EVENT_KEY_UP) {
+					continue;
+				}
+				auto keycode =
+					SDL_ConvertNumpadKeycode(
+						SDL_GetKeyFromScancode(e.key.scancode, e.key.mod, false),
+						e.key.mod & SDL_KMOD_NUM
+					);
+				if (keycode == SDLK_RETURN) {
+					// 用背景色擦除输入区域
+					erased = { x, y, std::max(drawn_width, prefix_widths.back() + cursor_width), line_height };
+					bgt_rectangle(erased.x, erased.y, erased.w, erased.h, bg_color.r, bg_color.g, bg_color.b, bg_color.a);
+					return parser(input_buf);
+				}
+				else if (keycode == SDLK_BACKSPACE) {
+					// 按了退格，删除一个字符
+					if (cursor_pos > 0) {
+						SDL_assert(cursor_pos <= static_cast<int>(input_buf.length()));
+						input_buf.erase(cursor_pos - 1, 1);
+						cursor_pos--;
+						update_prefix_widths(cursor_pos);
+						content_changed = true;
 					}
-					// 处理箭头按键
-					else if (keycode == SDLK_LEFT) {
-						if (cursor_pos > 0) {
-							cursor_pos--;
-						}
+				}
+				// 处理箭头按键
+				else if (keycode == SDLK_LEFT) {
+					if (cursor_pos > 0) {
+						cursor_pos--;
+						content_changed = true;
 					}
-					else if (keycode == SDLK_RIGHT) {
-						if (cursor_pos < input_buf.length()) {
-							cursor_pos++;
-						}
+				}
+				else if (keycode == SDLK_RIGHT) {
+					if (cursor_pos < static_cast<int>(input_buf.length())) {
+						cursor_pos++;
+						content_changed = true;
 					}
-					// 长度超过 max_len - 1 的输入部分会被丢弃
-					else if (input_buf.length() < max_len - 1) {
-						char ch = static_cast<char>(keycode);
-
-						SDL_assert(cursor_pos <= static_cast<int>(input_buf.length()));
+				}
+				// 长度超过 max_len - 1 的输入部分会被丢弃
+				else if (static_cast<int>(input_buf.length()) < max_len - 1) {
+					char ch = static_cast<char>(keycode);
 
-						auto new_str_with_ch = input_buf;
-						new_str_with_ch.insert(cursor_pos, 1, ch);
+					SDL_assert(cursor_pos <= static_cast<int>(input_buf.length()));
 
-						if (validator(new_str_with_ch)) {
-							input_buf = std::move(new_str_with_ch);
-							cursor_pos++;
-							text_width = bgt_measure_text(input_buf.c_str());
-						}
+					input_buf.insert(cursor_pos, 1, ch);
+					if (validator(input_buf)) {
+						update_prefix_widths(cursor_pos);
+						cursor_pos++;
+						content_changed = true;
+					}
+					else {
+						input_buf.erase(cursor_pos, 1);
 					}
-
-					break;
 				}
+			} while (poll_event(&e));
+
+			// 编辑后光标保持显示，重新开始闪烁计时
+			if (content_changed) {
+				start_tick = SDL_GetTicks();
 			}
 		}
 
@@ -317,16 +871,43 @@ namespace {
 } // namespace // namespace
 
 bool bgt_flush() {
-	// 如果一直不处理事件或者睡太久，窗口会假死
-	// 为了向新手使用者隔离事件机制，每次刷新的时候装模作样处理一下事件
-	// 实际上什么都没有处理，从队列里拿一个出来再放回去
-	SDL_Event e;
-	if (SDL_PollEvent(&e)) {
-		SDL_PushEvent(&e);
+	TraceRecorder::Scope trace_scope(tracer, "bgt_flush", "api");
+	RecordGuard record(CallOp::Flush);
+	// 批量模式下，刷新意味着一帧结束：先把积累的命令画上去
+	if (batch_depth > 0) {
+		submit_batch();
+		batch_flush_pending = false;
+	}
+	if (present_interval_ns == 0 && !present_on_idle) {
+		return present_frame();
+	}
+	// 开启了帧率限制：先记下这次请求，到了下一帧的时间再统一显示
+	present_pending = true;
+	if (present_due()) {
+		return present_frame();
+	}
+	return true;
+}
+
+void bgt_get_flush_stats(unsigned long long& presents, unsigned long long& pixels) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_get_flush_stats", "api");
+	presents = present_count;
+	pixels = pixels_pushed;
+}
+
+bool bgt_set_frame_rate(int fps) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_set_frame_rate", "api");
+	RecordGuard record(CallOp::SetFrameRate);
+	if (record) {
+		call_writer.putInts({ fps });
 	}
-	return SDL_SetRenderTarget(renderer, nullptr) && SDL_RenderClear(renderer) &&
-		SDL_RenderTexture(renderer, render_target, nullptr, nullptr) &&
-		SDL_RenderPresent(renderer);
+	if (fps < BGT_FRAME_RATE_ON_IDLE) {
+		return SDL_SetError("Invalid frame rate: %d", fps);
+	}
+	present_on_idle = fps == BGT_FRAME_RATE_ON_IDLE;
+	present_interval_ns = fps > 0 ? SDL_NS_PER_SECOND / fps : 0;
+	// 切换回不限帧率时，之前被推迟的内容应当马上显示出来
+	return present_interval_ns != 0 || present_on_idle || ensure_presented();
 }
 
 const char* bgt_get_error() {
@@ -338,7 +919,89 @@ const char* bgt_get_error() {
 #endif
 }
 
+namespace {
+	// bgt_init 与 bgt_init_headless 共用的部分：渲染器创建好之后，加载字体并创建画布
+	bool init_canvas(int w, int h, const char* font_name, int font_size) {
+		// 默认色彩混合模式为常规混合，半透明效果被标准处理
+		// 如果希望实现光影叠加等效果，可以调用 bgt_set_blend_mode 改变混合模式
+		SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+		// 加载字体及文本引擎
+		TraceRecorder::Scope trace_scope(tracer, "load_fonts", "font");
+		auto font_paths = FontManager().resolve(FontQuery()
+			.addFamily(font_name)
+			.addFamily("SimSun")
+			.addFamily("monospace")
+			.setWeight(FC_WEIGHT_REGULAR)
+			.setLang("zh-cn"));
+		SDL_assert_always(font_paths.size() && u8"没有找到任何字体文件，无法继续");
+
+		for (const auto& path : font_paths) {
+			TraceRecorder::Scope open_scope(tracer, "TTF_OpenFont", "font");
+			auto* current_font =  TTF_OpenFont(
+						reinterpret_cast<const char *>(path.u8string().c_str()),
+						font_size);
+			if (!font) {
+				font = current_font;
+			} else {
+				TTF_AddFallbackFont(font, current_font);
+			}
+		}
+
+		// 对于非等宽字体做出警告
+		// 新宋体实际上是等宽的，但没有设置等宽字体属性，故此处特判
+		bool is_fixed_width = TTF_FontIsFixedWidth(font) || strcmp(font_name, "SimSun") == 0;
+		if (!is_fixed_width) {
+			SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,
+				reinterpret_cast<const char*>(u8"%s 不是等宽字体。使用时请注意不同字符宽度不同的细节。"), font_name);
+		}
+
+		// 设置字体在亚像素级别渲染，能有效解决缩放后模糊的问题
+		TTF_SetFontHinting(font, TTF_HINTING_LIGHT_SUBPIXEL);
+		text_engine = TTF_CreateRendererTextEngine(renderer);
+		// 等宽字体的字形可以直接拼接，预先光栅化到图集里
+		if (is_fixed_width) {
+			glyph_atlas.init(renderer, font);
+		}
+		font_metrics.init(font, &glyph_atlas);
+
+		if (!(render_target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+			SDL_TEXTUREACCESS_TARGET, w, h))) {
+			return false;
+		}
+		// 脏区域按画布大小裁剪；第一次刷新需要完整显示初始的黑色画布
+		canvas_width = w;
+		canvas_height = h;
+		dirty_region.setBounds(w, h);
+		dirty_region.markAll();
+		present_count = 0;
+		pixels_pushed = 0;
+		profiler.reset();
+		return true;
+	}
+} // namespace
+
+bool bgt_set_renderer(const char* name) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_set_renderer", "api");
+	if (renderer) {
+		return SDL_SetError("bgt_set_renderer must be called before bgt_init");
+	}
+	requested_renderer = name ? name : "";
+	return true;
+}
+
+const char* bgt_get_renderer_name() {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_get_renderer_name", "api");
+	return renderer ? SDL_GetRendererName(renderer) : nullptr;
+}
+
 bool bgt_init(int w, int h, const char* title, const char* font_name, int font_size, bool fix_display_scale) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_init", "api");
+	RecordGuard record(CallOp::Init);
+	if (record) {
+		call_writer.putInts({ w, h, font_size });
+		call_writer.putString(font_name);
+	}
 	if (!SDL_Init(SDL_INIT_VIDEO) || !TTF_Init()) {
 		return false;
 	}
@@ -373,48 +1036,22 @@ bool bgt_init(int w, int h, const char* title, const char* font_name, int font_s
 	}
 
 	/* 由于 bgt 系列工具面向初学者，期望达到的效果是每次调用就在屏幕上对应画图，
-	   因此必须使用软件渲染器并关闭垂直同步，屏蔽掉缓冲区/硬件加速的复杂性 */
-	renderer = SDL_CreateRenderer(window, "software");
-	SDL_SetRenderVSync(renderer, SDL_RENDERER_VSYNC_DISABLED);
-
-	// 默认色彩混合模式为常规混合，半透明效果被标准处理
-	// 如果希望实现光影叠加等效果，可以调用 bgt_set_blend_mode 改变混合模式
-	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-
-	
-  // 加载字体及文本引擎
-  auto font_paths = FontManager().resolve(FontQuery()
-                                              .addFamily(font_name)
-                                              .addFamily("SimSun")
-                                              .addFamily("monospace")
-                                              .setWeight(FC_WEIGHT_REGULAR)
-                                              .setLang("zh-cn"));
-  SDL_assert_always(font_paths.size() && u8"没有找到任何字体文件，无法继续");
-
-	for (const auto& path : font_paths) {
-		auto* current_font =  TTF_OpenFont(
-					reinterpret_cast<const char *>(path.u8string().c_str()),
-					font_size);
-		if (!font) {
-			font = current_font;
-		} else {
-			TTF_AddFallbackFont(font, current_font);
-		}
+	   因此默认使用软件渲染器并关闭垂直同步，屏蔽掉缓冲区/硬件加速的复杂性
+	   所有内容都先画在 render_target 上，刷新时再整体拷贝到窗口，因此换用硬件加速的渲染器后行为不变 */
+	renderer = SDL_CreateRenderer(window, requested_renderer.empty() ? nullptr : requested_renderer.c_str());
+	if (!renderer && requested_renderer != SDL_SOFTWARE_RENDERER) {
+		// 没有显卡的环境（如远程桌面、CI）下硬件加速不可用，退回软件渲染
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Renderer \"%s\" is unavailable (%s), falling back to software",
+			requested_renderer.c_str(), SDL_GetError());
+		renderer = SDL_CreateRenderer(window, SDL_SOFTWARE_RENDERER);
 	}
-
-	// 对于非等宽字体做出警告
-	// 新宋体实际上是等宽的，但没有设置等宽字体属性，故此处特判
-	if (!TTF_FontIsFixedWidth(font) && strcmp(font_name, "SimSun") != 0) {
-		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,
-			reinterpret_cast<const char*>(u8"%s 不是等宽字体。使用时请注意不同字符宽度不同的细节。"), font_name);
+	if (!renderer) {
+		return false;
 	}
+	SDL_SetRenderVSync(renderer, SDL_RENDERER_VSYNC_DISABLED);
+	partial_present_supported = renderer && strcmp(SDL_GetRendererName(renderer), SDL_SOFTWARE_RENDERER) == 0;
 
-	// 设置字体在亚像素级别渲染，能有效解决缩放后模糊的问题
-	TTF_SetFontHinting(font, TTF_HINTING_LIGHT_SUBPIXEL);
-	text_engine = TTF_CreateRendererTextEngine(renderer);
-
-	if (!(render_target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
-		SDL_TEXTUREACCESS_TARGET, w, h))) {
+	if (!init_canvas(w, h, font_name, font_size)) {
 		return false;
 	}
 
@@ -428,10 +1065,12 @@ bool bgt_init(int w, int h, const char* title, const char* font_name, int font_s
 			case SDL_EVENT_WINDOW_RESIZED:
 			case SDL_EVENT_WINDOW_MAXIMIZED:
 			case SDL_EVENT_WINDOW_RESTORED:
-				// 窗口大小改变时，刷新一下以自动适配
-				// 理论上这里其实是不够安全的，因为事件可能来自其他线程，而 bgt_flush 必须在主线程调用
-				// 但测试表明这三个事件都会在主线程被处理，考虑到这是给新手的教学用框架，就暂时这样用着吧
-				bgt_flush();
+			case SDL_EVENT_WINDOW_EXPOSED:
+				// 窗口大小改变或者被遮挡后需要完整重绘，不受帧率限制
+				// 回调可能在 present_frame 内部的 SDL_PumpEvents 中、或者批量模式的一帧中间被调用，
+				// 这里只做标记，由下一次刷新或者等待输入时的 present_window_changes 显示
+				dirty_region.markAll();
+				present_pending = true;
 				break;
 			default:
 				break;
@@ -447,262 +1086,1518 @@ bool bgt_init(int w, int h, const char* title, const char* font_name, int font_s
 		SDL_RenderClear(renderer);
 }
 
-void bgt_quit() {
-	if (font) {
-		TTF_CloseFont(font);
-		font = nullptr;
-	}
-	if (render_target) {
-		SDL_DestroyTexture(render_target);
-		render_target = nullptr;
+bool bgt_init_headless(int w, int h, const char* font_name, int font_size) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_init_headless", "api");
+	RecordGuard record(CallOp::InitHeadless);
+	if (record) {
+		call_writer.putInts({ w, h, font_size });
+		call_writer.putString(font_name);
 	}
-	if (renderer) {
-		SDL_DestroyRenderer(renderer);
-		renderer = nullptr;
+	// 不需要视频子系统，因此在没有显示器的机器上也能运行
+	if (!SDL_Init(SDL_INIT_EVENTS) || !TTF_Init()) {
+		return false;
 	}
-	if (window) {
-		SDL_DestroyWindow(window);
-		window = nullptr;
+	// 画布之外的这块表面只是软件渲染器的必需品，永远不会被刷新到任何地方
+	if (!(headless_surface = SDL_CreateSurface(w, h, SDL_PIXELFORMAT_RGBA8888)) ||
+		!(renderer = SDL_CreateSoftwareRenderer(headless_surface))) {
+		return false;
 	}
-	TTF_Quit();
-	SDL_Quit();
+	headless = true;
+	partial_present_supported = false;
+	return init_canvas(w, h, font_name, font_size) &&
+		SDL_SetRenderTarget(renderer, render_target) &&
+		SDL_SetRenderDrawColor(renderer, 0, 0, 0, BGT_ALPHA_OPAQUE) &&
+		SDL_RenderClear(renderer);
 }
 
-bool bgt_cls(int r, int g, int b, bool flush) {
+bool bgt_save_frame(const char* path) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_save_frame", "api");
 	if (!renderer || !render_target) {
 		return false;
 	}
-	return SDL_SetRenderTarget(renderer, render_target) &&
-		SDL_SetRenderDrawColor(renderer, r, g, b, BGT_ALPHA_OPAQUE) &&
-		SDL_RenderClear(renderer) && (!flush || bgt_flush());
+	// 批量模式下记录的命令也应当出现在图像中
+	if (!submit_batch()) {
+		return false;
+	}
+	SDL_SetRenderTarget(renderer, render_target);
+	SDL_Surface* frame = SDL_RenderReadPixels(renderer, nullptr);
+	if (!frame) {
+		return false;
+	}
+#ifdef USE_ANSI
+	auto utf8_path = ansi_to_utf8(path);
+	bool ok = saveImage(utf8_path.c_str(), frame);
+#else
+	bool ok = saveImage(path, frame);
+#endif
+	SDL_DestroySurface(frame);
+	return ok;
 }
 
-bool bgt_rectangle(int x, int y, int w, int h, int r, int g, int b, int a,
-	bool flush) {
+bool bgt_compare_frame(const char* path, int tolerance, int& mismatched_pixels, const char* diff_path) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_compare_frame", "api");
+	mismatched_pixels = 0;
 	if (!renderer || !render_target) {
 		return false;
 	}
-	const SDL_FRect rect = { float(x), float(y), float(w), float(h) };
-
-	{
-		RenderDrawColorGuard _;
-		SDL_SetRenderTarget(renderer, render_target);
-		SDL_SetRenderDrawColor(renderer, r, g, b, a);
+	if (!submit_batch()) {
+		return false;
+	}
+#ifdef USE_ANSI
+	auto utf8_path = ansi_to_utf8(path);
+	SurfacePtr reference(loadImage(utf8_path.c_str()));
+#else
+	SurfacePtr reference(loadImage(path));
+#endif
+	if (!reference) {
+		return false;
+	}
+	SDL_SetRenderTarget(renderer, render_target);
+	SurfacePtr canvas(SDL_RenderReadPixels(renderer, nullptr));
+	SurfacePtr frame(canvas ? SDL_ConvertSurface(canvas.get(), SDL_PIXELFORMAT_RGB24) : nullptr);
+	if (!frame) {
+		return false;
+	}
+	if (frame->w != reference->w || frame->h != reference->h) {
+		return SDL_SetError("Reference image is %dx%d but the canvas is %dx%d",
+			reference->w, reference->h, frame->w, frame->h);
+	}
+
+	// 差异图：超出容差的像素标为红色，其余像素变暗显示以便对照位置
+	SurfacePtr diff(diff_path ? SDL_CreateSurface(frame->w, frame->h, SDL_PIXELFORMAT_RGB24) : nullptr);
+	if (diff_path && !diff) {
+		return false;
+	}
+	for (int y = 0; y < frame->h; y++) {
+		const auto* actual = static_cast<const Uint8*>(frame->pixels) + std::size_t(y) * frame->pitch;
+		const auto* expected = static_cast<const Uint8*>(reference->pixels) + std::size_t(y) * reference->pitch;
+		auto* marked = diff ? static_cast<Uint8*>(diff->pixels) + std::size_t(y) * diff->pitch : nullptr;
+		for (int x = 0; x < frame->w * 3; x += 3) {
+			bool mismatch = std::abs(actual[x] - expected[x]) > tolerance ||
+				std::abs(actual[x + 1] - expected[x + 1]) > tolerance ||
+				std::abs(actual[x + 2] - expected[x + 2]) > tolerance;
+			mismatched_pixels += mismatch;
+			if (marked) {
+				const Uint8 gray = static_cast<Uint8>((actual[x] + actual[x + 1] + actual[x + 2]) / 9);
+				marked[x] = mismatch ? 255 : gray;
+				marked[x + 1] = mismatch ? 0 : gray;
+				marked[x + 2] = mismatch ? 0 : gray;
+			}
+		}
+	}
+	if (!diff) {
+		return true;
+	}
+#ifdef USE_ANSI
+	auto utf8_diff_path = ansi_to_utf8(diff_path);
+	return saveImage(utf8_diff_path.c_str(), diff.get());
+#else
+	return saveImage(diff_path, diff.get());
+#endif
+}
+
+void bgt_quit() {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_quit", "api");
+	// 先写出活动记录，此时 SDL 还没有退出
+	bgt_stop_trace();
+	if (call_writer.isOpen()) {
+		call_writer.beginCall(CallOp::Quit);
+		bgt_stop_recording();
+	}
+	draw_batch.clear();
+	batch_depth = 0;
+	batch_flush_pending = false;
+	present_interval_ns = 0;
+	present_on_idle = false;
+	present_pending = false;
+	held_events.clear();
+	profiler.setEnabled(false);
+	profiler_overlay = false;
+	overlay_rect = {};
+	if (pixel_upload) {
+		SDL_DestroyTexture(pixel_upload);
+		pixel_upload = nullptr;
+	}
+	if (pixel_shadow) {
+		SDL_DestroySurface(pixel_shadow);
+		pixel_shadow = nullptr;
+	}
+	pixels_locked = false;
+	shadow_generation = UINT64_MAX;
+	current_blend_mode = SDL_BLENDMODE_BLEND;
+	keys_now.fill(false);
+	keys_prev.fill(false);
+	mouse_buttons_now = mouse_buttons_prev = 0;
+	// 缓存的文本依赖文本引擎，必须先于引擎和字体释放
+	text_cache.clear();
+	font_metrics.reset();
+	glyph_atlas.reset();
+	if (text_engine) {
+		TTF_DestroyRendererTextEngine(text_engine);
+		text_engine = nullptr;
+	}
+	if (font) {
+		TTF_CloseFont(font);
+		font = nullptr;
+	}
+	for (auto* layer : layers) {
+		if (layer) {
+			SDL_DestroyTexture(layer);
+		}
+	}
+	layers.clear();
+	draw_layer = BGT_CANVAS;
+	image_cache.clear();
+	if (render_target) {
+		SDL_DestroyTexture(render_target);
+		render_target = nullptr;
+	}
+	if (renderer) {
+		SDL_DestroyRenderer(renderer);
+		renderer = nullptr;
+	}
+	if (window) {
+		SDL_DestroyWindow(window);
+		window = nullptr;
+	}
+	if (headless_surface) {
+		SDL_DestroySurface(headless_surface);
+		headless_surface = nullptr;
+	}
+	headless = false;
+	TTF_Quit();
+	SDL_Quit();
+}
+
+bool bgt_cls(int r, int g, int b, bool flush) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_cls", "api");
+	RecordGuard record(CallOp::Cls);
+	if (record) {
+		call_writer.putInts({ r, g, b, flush });
+	}
+	if (!renderer || !render_target) {
+		return false;
+	}
+	FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Draw);
+	profiler.countDrawCall();
+	if (draw_layer == BGT_CANVAS) {
+		dirty_region.markAll();
+		canvas_generation++;
+	}
+	if (batch_depth > 0) {
+		draw_batch.addClear(to_color(r, g, b, BGT_ALPHA_OPAQUE));
+		return finish_draw(flush);
+	}
+	return SDL_SetRenderTarget(renderer, draw_target()) &&
+		SDL_SetRenderDrawColor(renderer, r, g, b, BGT_ALPHA_OPAQUE) &&
+		SDL_RenderClear(renderer) && finish_draw(flush);
+}
+
+bool bgt_rectangle(int x, int y, int w, int h, int r, int g, int b, int a,
+	bool flush) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_rectangle", "api");
+	RecordGuard record(CallOp::Rectangle);
+	if (record) {
+		call_writer.putInts({ x, y, w, h, r, g, b, a, flush });
+	}
+	if (!renderer || !render_target) {
+		return false;
+	}
+	FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Draw);
+	profiler.countDrawCall();
+	const SDL_FRect rect = { float(x), float(y), float(w), float(h) };
+	mark_dirty(x, y, w, h);
+
+	if (batch_depth > 0) {
+		draw_batch.addRects(to_color(r, g, b, a), { &rect, 1 });
+		return finish_draw(flush);
+	}
+	{
+		RenderDrawColorGuard _;
+		SDL_SetRenderTarget(renderer, draw_target());
+		SDL_SetRenderDrawColor(renderer, r, g, b, a);
 		SDL_RenderFillRect(renderer, &rect);
 	}
-	if (flush)
-		return bgt_flush();
-	return true;
+	return finish_draw(flush);
 }
 
 bool bgt_set_blend_mode(unsigned int mode) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_set_blend_mode", "api");
+	RecordGuard record(CallOp::SetBlendMode);
+	if (record) {
+		call_writer.putInts({ static_cast<int>(mode) });
+	}
 	if (!renderer || !render_target) {
 		return false;
 	}
-	return SDL_SetRenderDrawBlendMode(renderer, mode);
+	if (batch_depth > 0) {
+		draw_batch.addBlendMode(mode);
+		current_blend_mode = mode;
+		return true;
+	}
+	if (!SDL_SetRenderDrawBlendMode(renderer, mode)) {
+		return false;
+	}
+	current_blend_mode = mode;
+	return true;
 }
 
 bool bgt_line(int x1, int y1, int x2, int y2, int r, int g, int b, int a,
 	bool flush) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_line", "api");
+	RecordGuard record(CallOp::Line);
+	if (record) {
+		call_writer.putInts({ x1, y1, x2, y2, r, g, b, a, flush });
+	}
 	if (!renderer || !render_target) {
 		return false;
 	}
+	FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Draw);
+	profiler.countDrawCall();
+	mark_dirty(std::min(x1, x2), std::min(y1, y2), std::abs(x2 - x1) + 1, std::abs(y2 - y1) + 1);
+	if (batch_depth > 0) {
+		draw_batch.addLine(to_color(r, g, b, a), (float)x1, (float)y1, (float)x2, (float)y2);
+		return finish_draw(flush);
+	}
 	{
 		RenderDrawColorGuard _;
-		SDL_SetRenderTarget(renderer, render_target);
+		SDL_SetRenderTarget(renderer, draw_target());
 		SDL_SetRenderDrawColor(renderer, r, g, b, a);
 		SDL_RenderLine(renderer, (float)x1, (float)y1, (float)x2, (float)y2);
 	}
-	if (flush)
-		return bgt_flush();
-	return true;
+	return finish_draw(flush);
 }
 
+namespace {
+	// 圆和椭圆拆出来的扫描线，复用以避免每次绘制都分配内存
+	std::vector<SDL_FRect> shape_spans;
+
+	bool draw_ellipse(int center_x, int center_y, int radius_x, int radius_y, bool outline,
+		int r, int g, int b, int a, bool flush) {
+		if (!renderer || !render_target) {
+			return false;
+		}
+		FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Draw);
+		profiler.countDrawCall();
+		if (radius_x < 0 || radius_y < 0) {
+			return finish_draw(flush);
+		}
+		mark_dirty(center_x - radius_x, center_y - radius_y, 2 * radius_x + 1, 2 * radius_y + 1);
+		shape_spans.clear();
+		if (outline) {
+			appendEllipseOutlineSpans(center_x, center_y, radius_x, radius_y, shape_spans);
+		}
+		else {
+			appendEllipseSpans(center_x, center_y, radius_x, radius_y, shape_spans);
+		}
+		if (batch_depth > 0) {
+			// 批量模式下与其他同色图形合并提交
+			draw_batch.addRects(to_color(r, g, b, a), shape_spans);
+			return finish_draw(flush);
+		}
+		{
+			RenderDrawColorGuard _;
+			SDL_SetRenderTarget(renderer, draw_target());
+			SDL_SetRenderDrawColor(renderer, r, g, b, a);
+			// 整个图形只需一次提交
+			if (!SDL_RenderFillRects(renderer, shape_spans.data(), static_cast<int>(shape_spans.size()))) {
+				return false;
+			}
+		}
+		return finish_draw(flush);
+	}
+} // namespace
+
 bool bgt_circle(int center_x, int center_y, int radius, int r, int g, int b,
 	int a, bool flush) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_circle", "api");
+	RecordGuard record(CallOp::Circle);
+	if (record) {
+		call_writer.putInts({ center_x, center_y, radius, r, g, b, a, flush });
+	}
+	return draw_ellipse(center_x, center_y, radius, radius, false, r, g, b, a, flush);
+}
+
+bool bgt_circle_outline(int center_x, int center_y, int radius, int r, int g, int b,
+	int a, bool flush) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_circle_outline", "api");
+	RecordGuard record(CallOp::CircleOutline);
+	if (record) {
+		call_writer.putInts({ center_x, center_y, radius, r, g, b, a, flush });
+	}
+	return draw_ellipse(center_x, center_y, radius, radius, true, r, g, b, a, flush);
+}
+
+bool bgt_ellipse(int center_x, int center_y, int radius_x, int radius_y, int r, int g, int b,
+	int a, bool flush) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_ellipse", "api");
+	RecordGuard record(CallOp::Ellipse);
+	if (record) {
+		call_writer.putInts({ center_x, center_y, radius_x, radius_y, r, g, b, a, flush });
+	}
+	return draw_ellipse(center_x, center_y, radius_x, radius_y, false, r, g, b, a, flush);
+}
+
+bool bgt_ellipse_outline(int center_x, int center_y, int radius_x, int radius_y, int r, int g, int b,
+	int a, bool flush) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_ellipse_outline", "api");
+	RecordGuard record(CallOp::EllipseOutline);
+	if (record) {
+		call_writer.putInts({ center_x, center_y, radius_x, radius_y, r, g, b, a, flush });
+	}
+	return draw_ellipse(center_x, center_y, radius_x, radius_y, true, r, g, b, a, flush);
+}
+
+namespace {
+	// 批量绘制函数复用的缓冲区
+	std::vector<SDL_Vertex> bulk_vertices;
+	std::vector<int> bulk_indices;
+	std::vector<SDL_FPoint> bulk_points;
+
+	// bgt_draw_images 中使用同一纹理的一段连续精灵，在 bulk_vertices 与 bulk_indices 中的起点
+	struct SpriteRun {
+		SDL_Texture* texture;
+		std::size_t first_vertex, first_index;
+	};
+	std::vector<SpriteRun> sprite_runs;
+
+	bool same_color(SDL_Color x, SDL_Color y) {
+		return x.r == y.r && x.g == y.g && x.b == y.b && x.a == y.a;
+	}
+
+	// 所有图形的外接矩形，整批只标记一次脏区域
+	struct BulkBounds {
+		int x0 = INT_MAX, y0 = INT_MAX, x1 = INT_MIN, y1 = INT_MIN;
+
+		void add(int x, int y, int w, int h) {
+			x0 = std::min(x0, x);
+			y0 = std::min(y0, y);
+			x1 = std::max(x1, x + w);
+			y1 = std::max(y1, y + h);
+		}
+
+		void mark() const {
+			if (x0 < x1 && y0 < y1) {
+				mark_dirty(x0, y0, x1 - x0, y1 - y0);
+			}
+		}
+	};
+} // namespace
+
+bool bgt_rectangles(const BGT_Rect* rects, int count, bool flush) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_rectangles", "api");
+	RecordGuard record(CallOp::Rectangles);
+	if (record) {
+		call_writer.putInts({ std::max(count, 0), flush });
+		for (int i = 0; i < count; i++) {
+			const auto& e = rects[i];
+			call_writer.putInts({ e.x, e.y, e.w, e.h, e.r, e.g, e.b, e.a });
+		}
+	}
+	if (!renderer || !render_target) {
+		return false;
+	}
+	FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Draw);
+	profiler.countDrawCall();
+	if (count <= 0) {
+		return finish_draw(flush);
+	}
+
+	// 每个矩形拆成两个三角形，颜色写在顶点上，这样不同颜色的矩形也能一次提交
+	BulkBounds bounds;
+	bulk_vertices.resize(std::size_t(count) * 4);
+	bulk_indices.resize(std::size_t(count) * 6);
+	for (int i = 0; i < count; i++) {
+		const BGT_Rect& rect = rects[i];
+		bounds.add(rect.x, rect.y, rect.w, rect.h);
+		const SDL_FColor color = { rect.r / 255.0F, rect.g / 255.0F, rect.b / 255.0F, rect.a / 255.0F };
+		const float left = float(rect.x), top = float(rect.y);
+		const float right = float(rect.x + rect.w), bottom = float(rect.y + rect.h);
+		SDL_Vertex* v = &bulk_vertices[std::size_t(i) * 4];
+		v[0] = { { left, top }, color, { 0, 0 } };
+		v[1] = { { right, top }, color, { 0, 0 } };
+		v[2] = { { right, bottom }, color, { 0, 0 } };
+		v[3] = { { left, bottom }, color, { 0, 0 } };
+		int* index = &bulk_indices[std::size_t(i) * 6];
+		const int base = i * 4;
+		index[0] = base;
+		index[1] = base + 1;
+		index[2] = base + 2;
+		index[3] = base;
+		index[4] = base + 2;
+		index[5] = base + 3;
+	}
+	bounds.mark();
+
+	if (batch_depth > 0) {
+		draw_batch.addGeometry(bulk_vertices, bulk_indices);
+		return finish_draw(flush);
+	}
+	SDL_SetRenderTarget(renderer, draw_target());
+	if (!SDL_RenderGeometry(renderer, nullptr, bulk_vertices.data(), static_cast<int>(bulk_vertices.size()),
+		bulk_indices.data(), static_cast<int>(bulk_indices.size()))) {
+		return false;
+	}
+	return finish_draw(flush);
+}
+
+bool bgt_lines(const BGT_Line* lines, int count, bool flush) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_lines", "api");
+	RecordGuard record(CallOp::Lines);
+	if (record) {
+		call_writer.putInts({ std::max(count, 0), flush });
+		for (int i = 0; i < count; i++) {
+			const auto& e = lines[i];
+			call_writer.putInts({ e.x1, e.y1, e.x2, e.y2, e.r, e.g, e.b, e.a });
+		}
+	}
 	if (!renderer || !render_target) {
 		return false;
 	}
+	FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Draw);
+	profiler.countDrawCall();
+	if (count <= 0) {
+		return finish_draw(flush);
+	}
+
+	BulkBounds bounds;
+	for (int i = 0; i < count; i++) {
+		const BGT_Line& line = lines[i];
+		bounds.add(std::min(line.x1, line.x2), std::min(line.y1, line.y2),
+			std::abs(line.x2 - line.x1) + 1, std::abs(line.y2 - line.y1) + 1);
+	}
+	bounds.mark();
+
+	if (batch_depth > 0) {
+		for (int i = 0; i < count; i++) {
+			const BGT_Line& line = lines[i];
+			draw_batch.addLine(to_color(line.r, line.g, line.b, line.a),
+				float(line.x1), float(line.y1), float(line.x2), float(line.y2));
+		}
+		return finish_draw(flush);
+	}
 	{
+		// SDL 没有绘制多条独立线段的接口，但渲染目标与颜色只在需要时才设置
 		RenderDrawColorGuard _;
+		SDL_SetRenderTarget(renderer, draw_target());
+		SDL_Color current = to_color(lines[0].r, lines[0].g, lines[0].b, lines[0].a);
+		SDL_SetRenderDrawColor(renderer, current.r, current.g, current.b, current.a);
+		for (int i = 0; i < count; i++) {
+			const BGT_Line& line = lines[i];
+			const SDL_Color color = to_color(line.r, line.g, line.b, line.a);
+			if (!same_color(color, current)) {
+				SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+				current = color;
+			}
+			SDL_RenderLine(renderer, float(line.x1), float(line.y1), float(line.x2), float(line.y2));
+		}
+	}
+	return finish_draw(flush);
+}
+
+bool bgt_points(const BGT_Point* points, int count, bool flush) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_points", "api");
+	RecordGuard record(CallOp::Points);
+	if (record) {
+		call_writer.putInts({ std::max(count, 0), flush });
+		for (int i = 0; i < count; i++) {
+			const auto& e = points[i];
+			call_writer.putInts({ e.x, e.y, e.r, e.g, e.b, e.a });
+		}
+	}
+	if (!renderer || !render_target) {
+		return false;
+	}
+	FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Draw);
+	profiler.countDrawCall();
+	if (count <= 0) {
+		return finish_draw(flush);
+	}
+
+	BulkBounds bounds;
+	for (int i = 0; i < count; i++) {
+		bounds.add(points[i].x, points[i].y, 1, 1);
+	}
+	bounds.mark();
+
+	if (batch_depth > 0) {
+		// 批量模式下点就是 1x1 的矩形，同色的点会被合并
+		for (int i = 0; i < count; i++) {
+			const BGT_Point& point = points[i];
+			const SDL_FRect rect = { float(point.x), float(point.y), 1.0F, 1.0F };
+			draw_batch.addRects(to_color(point.r, point.g, point.b, point.a), { &rect, 1 });
+		}
+		return finish_draw(flush);
+	}
+	{
+		// 颜色相同的连续一段点只需一次 SDL_RenderPoints
+		RenderDrawColorGuard _;
+		SDL_SetRenderTarget(renderer, draw_target());
+		for (int first = 0; first < count;) {
+			const SDL_Color color = to_color(points[first].r, points[first].g, points[first].b, points[first].a);
+			bulk_points.clear();
+			int last = first;
+			for (; last < count; last++) {
+				const BGT_Point& point = points[last];
+				if (!same_color(color, to_color(point.r, point.g, point.b, point.a))) {
+					break;
+				}
+				bulk_points.push_back({ float(point.x), float(point.y) });
+			}
+			SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+			SDL_RenderPoints(renderer, bulk_points.data(), static_cast<int>(bulk_points.size()));
+			first = last;
+		}
+	}
+	return finish_draw(flush);
+}
+
+bool bgt_circles(const BGT_Circle* circles, int count, bool flush) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_circles", "api");
+	RecordGuard record(CallOp::Circles);
+	if (record) {
+		call_writer.putInts({ std::max(count, 0), flush });
+		for (int i = 0; i < count; i++) {
+			const auto& e = circles[i];
+			call_writer.putInts({ e.center_x, e.center_y, e.radius, e.r, e.g, e.b, e.a });
+		}
+	}
+	if (!renderer || !render_target) {
+		return false;
+	}
+	FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Draw);
+	profiler.countDrawCall();
+	if (count <= 0) {
+		return finish_draw(flush);
+	}
+
+	BulkBounds bounds;
+	for (int i = 0; i < count; i++) {
+		const BGT_Circle& circle = circles[i];
+		if (circle.radius >= 0) {
+			bounds.add(circle.center_x - circle.radius, circle.center_y - circle.radius,
+				2 * circle.radius + 1, 2 * circle.radius + 1);
+		}
+	}
+	bounds.mark();
+
+	RenderDrawColorGuard _;
+	if (batch_depth == 0) {
+		SDL_SetRenderTarget(renderer, draw_target());
+	}
+	// 颜色相同的连续一段圆的扫描线合并为一次提交
+	for (int first = 0; first < count;) {
+		const SDL_Color color = to_color(circles[first].r, circles[first].g, circles[first].b, circles[first].a);
+		shape_spans.clear();
+		int last = first;
+		for (; last < count; last++) {
+			const BGT_Circle& circle = circles[last];
+			if (!same_color(color, to_color(circle.r, circle.g, circle.b, circle.a))) {
+				break;
+			}
+			appendEllipseSpans(circle.center_x, circle.center_y, circle.radius, circle.radius, shape_spans);
+		}
+		if (batch_depth > 0) {
+			draw_batch.addRects(color, shape_spans);
+		}
+		else {
+			SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+			SDL_RenderFillRects(renderer, shape_spans.data(), static_cast<int>(shape_spans.size()));
+		}
+		first = last;
+	}
+	return finish_draw(flush);
+}
+
+int bgt_load_image(const char* path) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_load_image", "api");
+	RecordGuard record(CallOp::LoadImage);
+	if (record) {
+		call_writer.putString(path ? path : "");
+	}
+	if (!renderer || !render_target) {
+		return 0;
+	}
+	if (!path || !*path) {
+		SDL_SetError("Image path is empty");
+		return 0;
+	}
+#ifdef USE_ANSI
+	return image_cache.acquire(renderer, ansi_to_utf8(path).c_str());
+#else
+	return image_cache.acquire(renderer, path);
+#endif
+}
+
+bool bgt_set_image_atlas_size(int size) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_set_image_atlas_size", "api");
+	RecordGuard record(CallOp::SetImageAtlasSize);
+	if (record) {
+		call_writer.putInt(size);
+	}
+	// 太小的图集几乎装不下什么，只会徒增纹理数量
+	if (size != 0 && size < 64) {
+		return SDL_SetError("Invalid atlas size: %d", size);
+	}
+	image_cache.setAtlasSize(size);
+	return true;
+}
+
+bool bgt_free_image(int image) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_free_image", "api");
+	RecordGuard record(CallOp::FreeImage);
+	if (record) {
+		call_writer.putInt(image);
+	}
+	// 批量模式下可能还有引用这张图片的命令
+	if (!submit_batch()) {
+		return false;
+	}
+	return image_cache.release(image);
+}
+
+bool bgt_get_image_size(int image, int& w, int& h) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_get_image_size", "api");
+	const auto* found = image_cache.find(image);
+	if (!found) {
+		return SDL_SetError("Invalid image: %d", image);
+	}
+	w = found->width;
+	h = found->height;
+	return true;
+}
+
+bool bgt_draw_image(int image, int x, int y, int w, int h, int alpha, bool flush) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_draw_image", "api");
+	const auto opacity = static_cast<unsigned char>(std::clamp(alpha, 0, 255));
+	const BGT_Sprite sprite = { image, 0, 0, 0, 0, x, y, w, h, 255, 255, 255, opacity };
+	return bgt_draw_images(&sprite, 1, flush);
+}
+
+bool bgt_draw_images(const BGT_Sprite* sprites, int count, bool flush) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_draw_images", "api");
+	RecordGuard record(CallOp::DrawImages);
+	if (record) {
+		call_writer.putInts({ std::max(count, 0), flush });
+		for (int i = 0; i < count; i++) {
+			const auto& e = sprites[i];
+			call_writer.putInts({ e.image, e.src_x, e.src_y, e.src_w, e.src_h, e.x, e.y, e.w, e.h, e.r, e.g, e.b, e.a });
+		}
+	}
+	if (!renderer || !render_target) {
+		return false;
+	}
+	FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Draw);
+	profiler.countDrawCall();
+	if (count <= 0) {
+		return finish_draw(flush);
+	}
+
+	// 每个精灵拆成两个带纹理坐标的三角形；使用同一纹理的相邻精灵合并为一次提交
+	BulkBounds bounds;
+	bulk_vertices.clear();
+	bulk_indices.clear();
+	sprite_runs.clear();
+	bool all_valid = true;
+	for (int i = 0; i < count; i++) {
+		const BGT_Sprite& sprite = sprites[i];
+		const auto* image = image_cache.find(sprite.image);
+		if (!image) {
+			all_valid = false;
+			continue;
+		}
+		int src_x = sprite.src_x, src_y = sprite.src_y, src_w = sprite.src_w, src_h = sprite.src_h;
+		if (src_w <= 0 || src_h <= 0) {
+			src_x = src_y = 0;
+			src_w = image->width;
+			src_h = image->height;
+		}
+		// 源矩形限制在图片之内，否则会采样到纹理中相邻的内容
+		const int src_left = std::clamp(src_x, 0, image->width), src_top = std::clamp(src_y, 0, image->height);
+		const int src_right = std::clamp(src_x + src_w, 0, image->width);
+		const int src_bottom = std::clamp(src_y + src_h, 0, image->height);
+		if (src_left >= src_right || src_top >= src_bottom) {
+			continue;
+		}
+		const int w = sprite.w > 0 ? sprite.w : src_right - src_left;
+		const int h = sprite.h > 0 ? sprite.h : src_bottom - src_top;
+		bounds.add(sprite.x, sprite.y, w, h);
+
+		if (sprite_runs.empty() || sprite_runs.back().texture != image->texture) {
+			sprite_runs.push_back({ image->texture, bulk_vertices.size(), bulk_indices.size() });
+		}
+		const float u0 = (image->region.x + src_left) / image->textureWidth;
+		const float v0 = (image->region.y + src_top) / image->textureHeight;
+		const float u1 = (image->region.x + src_right) / image->textureWidth;
+		const float v1 = (image->region.y + src_bottom) / image->textureHeight;
+		const float left = float(sprite.x), top = float(sprite.y);
+		const float right = float(sprite.x + w), bottom = float(sprite.y + h);
+		const SDL_FColor color = { sprite.r / 255.0F, sprite.g / 255.0F, sprite.b / 255.0F, sprite.a / 255.0F };
+		const int base = static_cast<int>(bulk_vertices.size() - sprite_runs.back().first_vertex);
+		bulk_vertices.push_back({ { left, top }, color, { u0, v0 } });
+		bulk_vertices.push_back({ { right, top }, color, { u1, v0 } });
+		bulk_vertices.push_back({ { right, bottom }, color, { u1, v1 } });
+		bulk_vertices.push_back({ { left, bottom }, color, { u0, v1 } });
+		bulk_indices.insert(bulk_indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+	}
+	bounds.mark();
+
+	if (batch_depth == 0) {
+		SDL_SetRenderTarget(renderer, draw_target());
+	}
+	for (std::size_t i = 0; i < sprite_runs.size(); i++) {
+		const SpriteRun& run = sprite_runs[i];
+		const bool last = i + 1 == sprite_runs.size();
+		const std::size_t vertex_end = last ? bulk_vertices.size() : sprite_runs[i + 1].first_vertex;
+		const std::size_t index_end = last ? bulk_indices.size() : sprite_runs[i + 1].first_index;
+		const std::span<const SDL_Vertex> vertices(bulk_vertices.data() + run.first_vertex, vertex_end - run.first_vertex);
+		const std::span<const int> indices(bulk_indices.data() + run.first_index, index_end - run.first_index);
+		if (batch_depth > 0) {
+			draw_batch.addGeometry(vertices, indices, run.texture);
+			continue;
+		}
+		// 纹理有自己的混合模式，需要与 bgt_set_blend_mode 的设置保持一致
+		if (!SDL_SetTextureBlendMode(run.texture, current_blend_mode) ||
+			!SDL_RenderGeometry(renderer, run.texture, vertices.data(), static_cast<int>(vertices.size()),
+				indices.data(), static_cast<int>(indices.size()))) {
+			return false;
+		}
+	}
+	if (!all_valid) {
+		finish_draw(flush);
+		return SDL_SetError("Invalid image in sprite list");
+	}
+	return finish_draw(flush);
+}
+
+int bgt_create_layer(int w, int h) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_create_layer", "api");
+	RecordGuard record(CallOp::CreateLayer);
+	if (record) {
+		call_writer.putInts({ w, h });
+	}
+	if (!renderer || !render_target) {
+		return 0;
+	}
+	if (w <= 0 || h <= 0) {
+		w = canvas_width;
+		h = canvas_height;
+	}
+	SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
+	if (!texture) {
+		return 0;
+	}
+	// 图层初始为全透明，画在上面的半透明颜色会以预乘 alpha 的形式保存，见 bgt_composite_layer
+	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND_PREMULTIPLIED);
+	{
+		RenderDrawColorGuard _;
+		if (!SDL_SetRenderTarget(renderer, texture) ||
+			!SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0) ||
+			!SDL_RenderClear(renderer)) {
+			SDL_DestroyTexture(texture);
+			return 0;
+		}
+	}
+
+	auto slot = std::ranges::find(layers, nullptr);
+	if (slot == layers.end()) {
+		slot = layers.insert(layers.end(), texture);
+	}
+	else {
+		*slot = texture;
+	}
+	return static_cast<int>(slot - layers.begin()) + 1;
+}
+
+bool bgt_destroy_layer(int layer) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_destroy_layer", "api");
+	RecordGuard record(CallOp::DestroyLayer);
+	if (record) {
+		call_writer.putInt(layer);
+	}
+	SDL_Texture* texture = find_layer(layer);
+	if (!texture) {
+		return false;
+	}
+	// 批量模式下可能还有画到这个图层上的命令
+	if (layer == draw_layer) {
+		if (!submit_batch()) {
+			return false;
+		}
+		draw_layer = BGT_CANVAS;
+	}
+	SDL_DestroyTexture(texture);
+	layers[layer - 1] = nullptr;
+	return true;
+}
+
+bool bgt_set_draw_layer(int layer) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_set_draw_layer", "api");
+	RecordGuard record(CallOp::SetDrawLayer);
+	if (record) {
+		call_writer.putInt(layer);
+	}
+	if (layer != BGT_CANVAS && !find_layer(layer)) {
+		return false;
+	}
+	if (pixels_locked) {
+		return SDL_SetError("Cannot switch layers while pixels are locked");
+	}
+	// 批量模式下已经记录的命令属于之前的目标，必须在切换前画上去
+	if (layer != draw_layer && !submit_batch()) {
+		return false;
+	}
+	draw_layer = layer;
+	return true;
+}
+
+int bgt_get_draw_layer() {
+	return draw_layer;
+}
+
+bool bgt_clear_layer(int layer) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_clear_layer", "api");
+	RecordGuard record(CallOp::ClearLayer);
+	if (record) {
+		call_writer.putInt(layer);
+	}
+	SDL_Texture* texture = find_layer(layer);
+	if (!texture) {
+		return false;
+	}
+	FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Draw);
+	profiler.countDrawCall();
+	if (layer == draw_layer && !submit_batch()) {
+		return false;
+	}
+	RenderDrawColorGuard _;
+	return SDL_SetRenderTarget(renderer, texture) &&
+		SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0) &&
+		SDL_RenderClear(renderer);
+}
+
+bool bgt_composite_layer(int layer, int x, int y, int alpha, unsigned int mode, bool flush) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_composite_layer", "api");
+	RecordGuard record(CallOp::CompositeLayer);
+	if (record) {
+		call_writer.putInts({ layer, x, y, alpha, static_cast<int>(mode), flush });
+	}
+	SDL_Texture* texture = find_layer(layer);
+	if (!texture) {
+		return false;
+	}
+	if (layer == draw_layer) {
+		return SDL_SetError("Cannot composite layer %d onto itself", layer);
+	}
+	FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Draw);
+	profiler.countDrawCall();
+	// 保持与批量模式下记录的命令之间的先后顺序
+	if (!submit_batch()) {
+		return false;
+	}
+	float w, h;
+	if (!SDL_GetTextureSize(texture, &w, &h)) {
+		return false;
+	}
+	mark_dirty(x, y, static_cast<int>(w), static_cast<int>(h));
+
+	// 预乘 alpha 的颜色分量也要乘上整体透明度，否则半透明合成时颜色偏亮
+	const Uint8 opacity = static_cast<Uint8>(std::clamp(alpha, 0, 255));
+	const bool premultiplied = mode == BGT_BLENDMODE_BLEND_PREMULTIPLIED || mode == BGT_BLENDMODE_ADD_PREMULTIPLIED;
+	const Uint8 color_mod = premultiplied ? opacity : 255;
+	const SDL_FRect area = { float(x), float(y), w, h };
+	return SDL_SetTextureBlendMode(texture, static_cast<SDL_BlendMode>(mode)) &&
+		SDL_SetTextureAlphaMod(texture, opacity) &&
+		SDL_SetTextureColorMod(texture, color_mod, color_mod, color_mod) &&
+		SDL_SetRenderTarget(renderer, draw_target()) &&
+		SDL_RenderTexture(renderer, texture, nullptr, &area) &&
+		finish_draw(flush);
+}
+
+unsigned int* bgt_lock_pixels(int& pitch) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_lock_pixels", "api");
+	// 回放时也要加锁，之后录制的 bgt_pixels_* 调用才能真正执行
+	RecordGuard record(CallOp::LockPixels);
+	if (!renderer || !render_target) {
+		return nullptr;
+	}
+	if (pixels_locked) {
+		SDL_SetError("Pixels are already locked");
+		return nullptr;
+	}
+	if (draw_layer != BGT_CANVAS) {
+		SDL_SetError("Pixels can only be accessed on the main canvas");
+		return nullptr;
+	}
+	// 批量模式下记录的命令要先画上去，否则读回的内容不完整
+	if (!submit_batch()) {
+		return nullptr;
+	}
+	if (!pixel_shadow) {
+		if (!(pixel_shadow = SDL_CreateSurface(canvas_width, canvas_height, SDL_PIXELFORMAT_RGBA8888))) {
+			return nullptr;
+		}
+		shadow_generation = UINT64_MAX;
+	}
+	// 自上次解锁以来没有画过别的东西时，副本就是画布的内容，省去一次读回
+	if (shadow_generation != canvas_generation) {
 		SDL_SetRenderTarget(renderer, render_target);
-		SDL_SetRenderDrawColor(renderer, r, g, b, a);
-		for (int y = -radius; y <= radius; y++) {
-			int x = (int)sqrt(radius * radius - y * y); // Calculate x for given y
-			SDL_RenderLine(renderer, float(center_x - x), float(center_y + y), float(center_x + x),
-				float(center_y + y));
+		SDL_Surface* read = SDL_RenderReadPixels(renderer, nullptr);
+		if (!read) {
+			return nullptr;
 		}
+		bool ok = SDL_ConvertPixels(canvas_width, canvas_height, read->format, read->pixels, read->pitch,
+			pixel_shadow->format, pixel_shadow->pixels, pixel_shadow->pitch);
+		SDL_DestroySurface(read);
+		if (!ok) {
+			return nullptr;
+		}
+		shadow_generation = canvas_generation;
+	}
+	pixels_locked = true;
+	pitch = pixel_shadow->pitch / static_cast<int>(sizeof(unsigned int));
+	return static_cast<unsigned int*>(pixel_shadow->pixels);
+}
+
+bool bgt_unlock_pixels(bool flush) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_unlock_pixels", "api");
+	if (!pixels_locked) {
+		return SDL_SetError("Pixels are not locked");
+	}
+	pixels_locked = false;
+	if (!renderer || !render_target) {
+		return false;
+	}
+	// 不知道调用者改了哪些像素，只能记录整个画布
+	RecordGuard record(CallOp::UnlockPixels);
+	if (record) {
+		call_writer.putInts({ canvas_width, canvas_height, flush });
+		call_writer.putPixels(static_cast<const Uint32*>(pixel_shadow->pixels),
+			pixel_shadow->pitch / static_cast<int>(sizeof(Uint32)), canvas_width, canvas_height);
+	}
+	FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Draw);
+	profiler.countDrawCall();
+	if (!pixel_upload) {
+		if (!(pixel_upload = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+			SDL_TEXTUREACCESS_STREAMING, canvas_width, canvas_height))) {
+			return false;
+		}
+		// 像素原样覆盖画布，不与原有内容混合
+		SDL_SetTextureBlendMode(pixel_upload, SDL_BLENDMODE_NONE);
+	}
+	SDL_SetRenderTarget(renderer, render_target);
+	if (!SDL_UpdateTexture(pixel_upload, nullptr, pixel_shadow->pixels, pixel_shadow->pitch) ||
+		!SDL_RenderTexture(renderer, pixel_upload, nullptr, nullptr)) {
+		return false;
+	}
+	dirty_region.markAll();
+	// 画布现在与副本一致，下次加锁时无需读回
+	shadow_generation = ++canvas_generation;
+	return finish_draw(flush);
+}
+
+namespace {
+	// 把矩形裁剪到画布内，返回裁剪后是否还有像素
+	bool clip_to_canvas(int& x, int& y, int& w, int& h, int& skip_x, int& skip_y) {
+		skip_x = x < 0 ? -x : 0;
+		skip_y = y < 0 ? -y : 0;
+		x += skip_x;
+		y += skip_y;
+		w = std::min(w - skip_x, canvas_width - x);
+		h = std::min(h - skip_y, canvas_height - y);
+		return w > 0 && h > 0;
+	}
+
+	const PixelKernels* locked_kernels() {
+		if (!pixels_locked) {
+			SDL_SetError("Pixels are not locked");
+			return nullptr;
+		}
+		const PixelKernels* kernels = pixelKernels(current_blend_mode);
+		if (!kernels) {
+			SDL_SetError("Blend mode 0x%x is not supported on locked pixels", current_blend_mode);
+		}
+		return kernels;
+	}
+} // namespace
+
+bool bgt_pixels_fill_rect(int x, int y, int w, int h, int r, int g, int b, int a) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_pixels_fill_rect", "api");
+	RecordGuard record(CallOp::PixelsFillRect);
+	if (record) {
+		call_writer.putInts({ x, y, w, h, r, g, b, a });
+	}
+	FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Draw);
+	profiler.countDrawCall();
+	const PixelKernels* kernels = locked_kernels();
+	if (!kernels) {
+		return false;
+	}
+	int skip_x, skip_y;
+	if (!clip_to_canvas(x, y, w, h, skip_x, skip_y)) {
+		return true;
+	}
+	const Uint32 color = BGT_PIXEL(r & 0xFF, g & 0xFF, b & 0xFF, a & 0xFF);
+	auto* row = static_cast<Uint8*>(pixel_shadow->pixels) + std::size_t(y) * pixel_shadow->pitch;
+	for (int i = 0; i < h; i++, row += pixel_shadow->pitch) {
+		kernels->fill(reinterpret_cast<Uint32*>(row) + x, w, color);
+	}
+	return true;
+}
+
+bool bgt_pixels_blit(const unsigned int* src, int src_pitch, int x, int y, int w, int h) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_pixels_blit", "api");
+	RecordGuard record(CallOp::PixelsBlit);
+	if (record) {
+		call_writer.putInts({ x, y, std::max(w, 0), std::max(h, 0) });
+		if (src && w > 0 && h > 0) {
+			call_writer.putPixels(src, src_pitch, w, h);
+		}
+	}
+	FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Draw);
+	profiler.countDrawCall();
+	const PixelKernels* kernels = locked_kernels();
+	if (!kernels) {
+		return false;
+	}
+	int skip_x, skip_y;
+	if (!clip_to_canvas(x, y, w, h, skip_x, skip_y)) {
+		return true;
+	}
+	src += std::size_t(skip_y) * src_pitch + skip_x;
+	auto* row = static_cast<Uint8*>(pixel_shadow->pixels) + std::size_t(y) * pixel_shadow->pitch;
+	for (int i = 0; i < h; i++, row += pixel_shadow->pitch, src += src_pitch) {
+		kernels->blit(reinterpret_cast<Uint32*>(row) + x, src, w);
 	}
-	if (flush)
-		return bgt_flush();
 	return true;
 }
 
 int bgt_get_font_width() {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_get_font_width", "api");
 	if (!font) {
 		return 0;
 	}
-	return bgt_measure_text(" ");
+	return font_metrics.spaceWidth();
 }
 
 int bgt_get_font_height() {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_get_font_height", "api");
 	if (!font) {
 		return 0;
 	}
-	return TTF_GetFontHeight(font);
+	return font_metrics.height();
 }
 
 int bgt_measure_text(const char* str)
 {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_measure_text", "api");
+	return bgt_measure_text(str, static_cast<int>(std::strlen(str)));
+}
+
+int bgt_measure_text(const char* str, int len)
+{
+	TraceRecorder::Scope trace_scope(tracer, "bgt_measure_text", "api");
+	RecordGuard record(CallOp::MeasureText);
+	if (record) {
+		call_writer.putString(std::string_view(str, std::max(len, 0)));
+	}
+	if (!font || len <= 0) {
+		return 0;
+	}
 #ifdef USE_ANSI
-	auto converted_str = ansi_to_utf8(str);
-	const char* str_to_measure = converted_str.c_str();
-	std::size_t len = converted_str.length();
+	// 复用同一个缓冲区做编码转换，避免每次测量都分配内存
+	static std::string converted_str;
+	ansi_to_utf8(std::string_view(str, len), converted_str);
+	return font_metrics.measure(converted_str);
 #else
-	const char* str_to_measure = str;
-	std::size_t len = std::strlen(str);
+	return font_metrics.measure(std::string_view(str, len));
 #endif
-
-	int w;
-	TTF_MeasureString(font, str_to_measure, len, 0, &w, nullptr);
-	return w;
 }
 
 int bgt_show_str(int x, int y, const char* str, int r, int g, int b, int a, bool flush) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_show_str", "api");
+	RecordGuard record(CallOp::ShowStr);
+	if (record) {
+		call_writer.putInts({ x, y, r, g, b, a, flush });
+		call_writer.putString(str ? str : "");
+	}
+	FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Text);
+	profiler.countDrawCall();
 
 #ifdef USE_ANSI
-	auto converted_str = ansi_to_utf8(str);
+	static std::string converted_str;
+	ansi_to_utf8(str, converted_str);
 	const char* utf8_str = converted_str.c_str();
 
 #else
 	const char* utf8_str = str;
 #endif
-	int text_width_in_pixel;
-	TTF_MeasureString(font, utf8_str, 0, 0, &text_width_in_pixel, nullptr);
-
-	auto* text = TTF_CreateText(text_engine, font, utf8_str, 0);
+	// 等宽字体优先使用字形图集，直接拼接字形而不必排版
+	// 否则排版结果与宽度都来自缓存，重复绘制相同的字符串时不必重新排版
+	int text_width_in_pixel = 0;
+	TTF_Text* text = nullptr;
+	bool use_atlas = glyph_atlas.enabled() && glyph_atlas.measure(utf8_str, &text_width_in_pixel);
+	if (!use_atlas) {
+		text = acquire_text(utf8_str, &text_width_in_pixel);
+		if (!text) {
+			return false;
+		}
+	}
+	// 斜体等字形可能略微超出测量宽度，左右各多留一点余量
+	mark_dirty(x - 2, y, text_width_in_pixel + 4, TTF_GetFontHeight(font));
 
-	if (!text) {
-		return false;
+	if (batch_depth > 0) {
+		draw_batch.addText(to_color(r, g, b, a), (float)x, (float)y, utf8_str);
+		finish_draw(flush);
+		return text_width_in_pixel;
 	}
 	{
 		RenderDrawColorGuard _;
-		TTF_SetTextColor(text, r, g, b, a);
-		SDL_SetRenderTarget(renderer, render_target);
-		TTF_DrawRendererText(text, (float)x, (float)y);
+		SDL_SetRenderTarget(renderer, draw_target());
+		bool ok = use_atlas ? glyph_atlas.draw(utf8_str, (float)x, (float)y, to_color(r, g, b, a))
+			: draw_text(text, (float)x, (float)y, to_color(r, g, b, a));
+		if (!ok) {
+			return false;
+		}
 	}
-	if (flush)
-		bgt_flush();
-	TTF_DestroyText(text);
+	finish_draw(flush);
 	return text_width_in_pixel;
 }
 
 void bgt_delay(int ms) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_delay", "api");
+	RecordGuard record(CallOp::Delay);
+	if (record) {
+		call_writer.putInts({ ms });
+	}
+	ensure_presented();
+	if (ms <= 0) {
+		return;
+	}
 	// 如果一直不处理事件或者睡太久，窗口会假死
-	// 为了向新手使用者隔离事件机制，每睡 50ms 就醒过来装模作样处理一下事件
-	constexpr int SLEEP_SLICE_MS = 50;
-	while (ms > 0) {
-		SDL_Delay(ms > SLEEP_SLICE_MS ? SLEEP_SLICE_MS : ms);
-		ms -= SLEEP_SLICE_MS;
+	// 因此不是单纯地睡觉，而是等待事件到来或者时间截止，有事件时醒来收下，之后再交给读取函数
+	wait_until(SDL_GetTicksNS() + SDL_MS_TO_NS(ms));
+}
 
-		SDL_Event e;
-		// 实际上什么都没有处理，从队列里拿一个出来再放回去
-		if (SDL_PollEvent(&e)) {
-			SDL_PushEvent(&e);
-		}
+void bgt_enable_profiler(bool enable) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_enable_profiler", "api");
+	if (!enable) {
+		// 浮层的内容来自统计，统计停用后浮层也就没有意义了
+		bgt_show_profiler_overlay(false);
 	}
+	profiler.setEnabled(enable);
+}
+
+void bgt_get_frame_stats(BGT_FrameStats& stats) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_get_frame_stats", "api");
+	// 忘了调用 bgt_enable_profiler 时从现在开始统计，下次调用就有数据了
+	profiler.setEnabled(true);
+	const auto& frame = profiler.lastFrame();
+	const auto lookups = frame.cacheHits + frame.cacheMisses;
+	stats.fps = profiler.fps();
+	stats.frame_ms = frame.frameMs;
+	stats.draw_ms = frame.zoneMs[FrameProfiler::Draw];
+	stats.text_ms = frame.zoneMs[FrameProfiler::Text];
+	stats.text_shaping_ms = frame.zoneMs[FrameProfiler::TextShaping];
+	stats.present_ms = frame.zoneMs[FrameProfiler::Present];
+	stats.event_ms = frame.zoneMs[FrameProfiler::Events];
+	stats.draw_calls = frame.drawCalls;
+	stats.pixels_pushed = frame.pixels;
+	stats.text_cache_hit_rate = lookups ? double(frame.cacheHits) / double(lookups) : 1.0;
+}
+
+void bgt_show_profiler_overlay(bool show) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_show_profiler_overlay", "api");
+	if (profiler_overlay && !show) {
+		// 下次刷新时用画布完整覆盖窗口，擦掉浮层
+		dirty_region.markAll();
+		overlay_rect = {};
+	}
+	if (show) {
+		profiler.setEnabled(true);
+	}
+	profiler_overlay = show;
+}
+
+bool bgt_start_trace(const char* path, int max_events) {
+	if (!path || !*path) {
+		return SDL_SetError("Trace file path is empty");
+	}
+	if (max_events <= 0) {
+		return SDL_SetError("Invalid trace capacity: %d", max_events);
+	}
+#ifdef USE_ANSI
+	trace_path = ansi_to_utf8(path);
+#else
+	trace_path = path;
+#endif
+	tracer.start(static_cast<std::size_t>(max_events));
+	return true;
+}
+
+bool bgt_save_trace(const char* path) {
+	if (!tracer.enabled()) {
+		return SDL_SetError("Tracing is not started");
+	}
+	if (!path) {
+		return tracer.writeChromeTrace(trace_path.c_str());
+	}
+#ifdef USE_ANSI
+	return tracer.writeChromeTrace(ansi_to_utf8(path).c_str());
+#else
+	return tracer.writeChromeTrace(path);
+#endif
+}
+
+bool bgt_stop_trace() {
+	if (!tracer.enabled()) {
+		return true;
+	}
+	tracer.stop();
+	const bool ok = tracer.writeChromeTrace(trace_path.c_str());
+	tracer.reset();
+	trace_path.clear();
+	return ok;
+}
+
+bool bgt_start_recording(const char* path) {
+	if (!path || !*path) {
+		return SDL_SetError("Recording file path is empty");
+	}
+	// 回放需要从初始化开始，才知道画布的大小和字体
+	if (renderer) {
+		return SDL_SetError("bgt_start_recording must be called before bgt_init");
+	}
+#ifdef USE_ANSI
+	return call_writer.open(ansi_to_utf8(path).c_str());
+#else
+	return call_writer.open(path);
+#endif
+}
+
+bool bgt_stop_recording() {
+	return call_writer.close();
+}
+
+void bgt_set_text_cache_budget(unsigned long long bytes) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_set_text_cache_budget", "api");
+	RecordGuard record(CallOp::SetTextCacheBudget);
+	if (record) {
+		call_writer.putUint(bytes);
+	}
+	text_cache.setBudget(static_cast<std::size_t>(bytes));
+}
+
+void bgt_get_text_cache_stats(unsigned long long& hits, unsigned long long& misses) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_get_text_cache_stats", "api");
+	hits = text_cache.hits();
+	misses = text_cache.misses();
+}
+
+bool bgt_update_input_state() {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_update_input_state", "api");
+	if (!renderer) {
+		return false;
+	}
+	// 只从系统收取事件以更新 SDL 内部的状态，事件本身仍留在队列里，不影响 bgt_getch 等函数
+	{
+		FrameProfiler::Scope profile_scope(profiler, FrameProfiler::Events);
+		SDL_PumpEvents();
+	}
+
+	keys_prev = keys_now;
+	int num_keys = 0;
+	const bool* state = SDL_GetKeyboardState(&num_keys);
+	for (int i = 0; i < static_cast<int>(keys_now.size()); i++) {
+		keys_now[i] = i < num_keys && state[i];
+	}
+
+	mouse_buttons_prev = mouse_buttons_now;
+	float window_x, window_y;
+	mouse_buttons_now = SDL_GetMouseState(&window_x, &window_y);
+	// 与事件中的坐标一样，换算到 bgt_init 指定的逻辑坐标系
+	return SDL_RenderCoordinatesFromWindow(renderer, window_x, window_y, &snapshot_mouse_x, &snapshot_mouse_y);
+}
+
+namespace {
+	int scancode_index(int keycode) {
+		auto scancode = SDL_GetScancodeFromKey(static_cast<SDL_Keycode>(keycode), nullptr);
+		return scancode > SDL_SCANCODE_UNKNOWN && scancode < SDL_SCANCODE_COUNT ? scancode : -1;
+	}
+
+	bool mouse_button_in(SDL_MouseButtonFlags flags, int button) {
+		return button >= BGT_MOUSE_LEFT && button <= BGT_MOUSE_X2 && (flags & SDL_BUTTON_MASK(button));
+	}
+} // namespace
+
+bool bgt_key_down(int keycode) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_key_down", "api");
+	int i = scancode_index(keycode);
+	return i >= 0 && keys_now[i];
+}
+
+bool bgt_key_pressed(int keycode) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_key_pressed", "api");
+	int i = scancode_index(keycode);
+	return i >= 0 && keys_now[i] && !keys_prev[i];
+}
+
+bool bgt_key_released(int keycode) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_key_released", "api");
+	int i = scancode_index(keycode);
+	return i >= 0 && !keys_now[i] && keys_prev[i];
+}
+
+bool bgt_mouse_down(int button) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_mouse_down", "api");
+	return mouse_button_in(mouse_buttons_now, button);
+}
+
+bool bgt_mouse_pressed(int button) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_mouse_pressed", "api");
+	return mouse_button_in(mouse_buttons_now, button) && !mouse_button_in(mouse_buttons_prev, button);
+}
+
+bool bgt_mouse_released(int button) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_mouse_released", "api");
+	return !mouse_button_in(mouse_buttons_now, button) && mouse_button_in(mouse_buttons_prev, button);
+}
+
+void bgt_get_mouse_position(int& mouse_x, int& mouse_y) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_get_mouse_position", "api");
+	mouse_x = static_cast<int>(snapshot_mouse_x);
+	mouse_y = static_cast<int>(snapshot_mouse_y);
+}
+
+void bgt_begin_batch() {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_begin_batch", "api");
+	RecordGuard record(CallOp::BeginBatch);
+	batch_depth++;
+}
+
+bool bgt_end_batch() {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_end_batch", "api");
+	RecordGuard record(CallOp::EndBatch);
+	if (batch_depth <= 0) {
+		return SDL_SetError("bgt_end_batch called without matching bgt_begin_batch");
+	}
+	if (--batch_depth > 0) {
+		return true;
+	}
+	bool ok = renderer && render_target ? submit_batch() : true;
+	if (batch_flush_pending) {
+		batch_flush_pending = false;
+		ok = bgt_flush() && ok;
+	}
+	return ok;
 }
 
 unsigned long long bgt_get_ticks()
 {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_get_ticks", "api");
 	return SDL_GetTicks();
 }
 
 int bgt_getch() {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_getch", "api");
+	ensure_presented();
 	SDL_Event e;
 
-	while (SDL_WaitEvent(&e)) {
+	while (wait_event(&e, -1)) {
 		switch (e.type) {
 		case SDL_EVENT_KEY_DOWN:
 			// 通过 GetKeyFromScancode 获取按键码
 			// key_event 参数为 false 时，该函数会正确处理 Shift/Capslock 等修饰符，给出一个对用户友好的结果
 			auto keycode = SDL_GetKeyFromScancode(e.key.scancode, e.key.mod, false);
 			// 额外手动处理一下小键盘的按键
-			return SDL_ConvertNumpadKeycode(keycode, e.key.mod & SDL_KMOD_NUM);
+			keycode = SDL_ConvertNumpadKeycode(keycode, e.key.mod & SDL_KMOD_NUM);
+			record_input(CallOp::Getch, { static_cast<int>(keycode) });
+			return keycode;
 		}
 	}
-	std::unreachable();
+	// 只有无窗口模式下输入耗尽时才会走到这里
+	record_input(CallOp::Getch, { 0 });
+	return 0;
 }
 
 BGT_Ostream bgt_cout(int x, int y, int r, int g, int b, int a, bool flush)
 {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_cout", "api");
 	return BGT_Ostream{x, y, r, g, b, a, flush};
 }
 
 int bgt_read_keyboard_and_mouse(int& mouse_x, int& mouse_y, int& mouse_action,
 	int& keycode, int& key_modifier) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_read_keyboard_and_mouse", "api");
 	SDL_Event e;
 	keycode = 0;
 	key_modifier = 0;
 
-	while (SDL_PollEvent(&e)) {
-		SDL_ConvertEventToRenderCoordinates(renderer, &e);
-		switch (e.type) {
-		case SDL_EVENT_KEY_UP:
-			keycode = e.key.key;
-			key_modifier = e.key.mod;
-			mouse_action = MOUSE_NO_ACTION;
-			return BGT_KEYBOARD_EVENT;
-		case SDL_EVENT_MOUSE_BUTTON_DOWN:
-			mouse_x = static_cast<int>(e.button.x);
-			mouse_y = static_cast<int>(e.button.y);
-			// 鼠标左键
-			if (e.button.button == SDL_BUTTON_LEFT) {
-				if (e.button.clicks == 1) {
-					mouse_action = MOUSE_LEFT_BUTTON_CLICK;
-				}
-				else {
-					// 暂时把多次点击视为双击
-					mouse_action = MOUSE_LEFT_BUTTON_DOUBLE_CLICK;
-				}
-			}
-			else if (e.button.button == SDL_BUTTON_MIDDLE) {
-				mouse_action = MOUSE_WHEEL_CLICK;
-			}
-			else {
-				// 暂时把鼠标侧键当成右键
-				if (e.button.clicks == 1) {
-					mouse_action = MOUSE_RIGHT_BUTTON_CLICK;
-				}
-				else {
-					mouse_action = MOUSE_RIGHT_BUTTON_DOUBLE_CLICK;
-				}
-			}
-			return BGT_MOUSE_EVENT;
-		case SDL_EVENT_MOUSE_WHEEL:
-			mouse_x = static_cast<int>(e.wheel.mouse_x);
-			mouse_y = static_cast<int>(e.wheel.mouse_y);
-			if (e.wheel.y > 0) {
-				mouse_action = MOUSE_WHEEL_MOVED_UP;
-			}
-			else {
-				mouse_action = MOUSE_WHEEL_MOVED_DOWN;
-			}
-			return BGT_MOUSE_EVENT;
-		case SDL_EVENT_MOUSE_MOTION:
-			mouse_x = static_cast<int>(e.motion.x);
-			mouse_y = static_cast<int>(e.motion.y);
-			mouse_action = MOUSE_ONLY_MOVED;
-			return BGT_MOUSE_EVENT;
-		default:
-			break;
+	present_if_idle_or_due();
+
+	// 未填写的字段保持调用者原来的值
+	BGT_Event event{ BGT_NO_EVENT, mouse_x, mouse_y, mouse_action, 0, 0 };
+	while (poll_event(&e)) {
+		if (translate_event(e, event) != BGT_NO_EVENT) {
+			mouse_x = event.mouse_x;
+			mouse_y = event.mouse_y;
+			mouse_action = event.mouse_action;
+			keycode = event.keycode;
+			key_modifier = event.key_modifier;
+			record_input(CallOp::ReadKeyboardAndMouse,
+				{ event.type, mouse_x, mouse_y, mouse_action, keycode, key_modifier });
+			return event.type;
 		}
 	}
 	return BGT_NO_EVENT;
 }
 
+int bgt_read_events(BGT_Event* events, int max_events) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_read_events", "api");
+	if (!events || max_events <= 0) {
+		return 0;
+	}
+
+	present_if_idle_or_due();
+
+	int count = 0;
+	SDL_Event e;
+	while (poll_event(&e)) {
+		// 坐标转换会修改事件本身，保留一份原始事件以便放回队列
+		const SDL_Event raw = e;
+		BGT_Event event{ BGT_NO_EVENT, 0, 0, MOUSE_NO_ACTION, 0, 0 };
+		if (translate_event(e, event) == BGT_NO_EVENT) {
+			continue;
+		}
+		// 连续的鼠标移动只保留最新位置，避免高回报率鼠标的事件淹没其他输入
+		if (count > 0 && event.mouse_action == MOUSE_ONLY_MOVED &&
+			events[count - 1].mouse_action == MOUSE_ONLY_MOVED) {
+			events[count - 1] = event;
+			continue;
+		}
+		if (count == max_events) {
+			// 放不下了，原样放回队首，留给下一次读取
+			held_events.push_front(raw);
+			break;
+		}
+		events[count++] = event;
+	}
+	if (count > 0 && call_writer.isOpen()) {
+		call_writer.beginCall(CallOp::ReadEvents);
+		call_writer.putInt(count);
+		for (int i = 0; i < count; i++) {
+			const auto& e = events[i];
+			call_writer.putInts({ e.type, e.mouse_x, e.mouse_y, e.mouse_action, e.keycode, e.key_modifier });
+		}
+	}
+	return count;
+}
+
 
 int bgt_input_number(int x, int y, int fg_r, int fg_g, int fg_b, int fg_a, int bg_r, int bg_g, int bg_b) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_input_number", "api");
+	// 回显用的绘制调用不单独录制，结果在输入结束后补写到这条记录里
+	RecordGuard record(CallOp::InputNumber);
 	auto parser = [](std::string_view sv) -> int {
 		int result;
 		if (std::from_chars(sv.data(), sv.data() + sv.size(), result).ec == std::errc{}) {
@@ -719,17 +2614,29 @@ int bgt_input_number(int x, int y, int fg_r, int fg_g, int fg_b, int fg_a, int b
 			return ch >= '0' && ch <= '9';
 				});
 		};
-	return bgt_input(x, y,
+	SDL_Rect erased{};
+	const int result = bgt_input(x, y,
 		SDL_Color{ static_cast<Uint8>(bg_r), static_cast<Uint8>(bg_g), static_cast<Uint8>(bg_b), BGT_ALPHA_OPAQUE },
 		SDL_Color{ static_cast<Uint8>(fg_r), static_cast<Uint8>(fg_g), static_cast<Uint8>(fg_b), static_cast<Uint8>(fg_a) },
 		11, // -2147483648 共 11 个字符
-		validator, parser);
+		erased, validator, parser);
+	if (record) {
+		call_writer.putInts({ erased.x, erased.y, erased.w, erased.h, bg_r, bg_g, bg_b, result });
+	}
+	return result;
 }
 
 int bgt_input_ascii(int x, int y, char* buf, int max_len, int fg_r, int fg_g, int fg_b, int fg_a, int bg_r, int bg_g, int bg_b) {
+	TraceRecorder::Scope trace_scope(tracer, "bgt_input_ascii", "api");
+	RecordGuard record(CallOp::InputAscii);
+	SDL_Rect erased{};
 	auto result = bgt_input(x, y,
 		SDL_Color{ static_cast<Uint8>(bg_r), static_cast<Uint8>(bg_g), static_cast<Uint8>(bg_b), BGT_ALPHA_OPAQUE },
 		SDL_Color{ static_cast<Uint8>(fg_r), static_cast<Uint8>(fg_g), static_cast<Uint8>(fg_b), static_cast<Uint8>(fg_a) },
-		max_len);
+		max_len, erased);
+	if (record) {
+		call_writer.putInts({ erased.x, erased.y, erased.w, erased.h, bg_r, bg_g, bg_b });
+		call_writer.putString(result);
+	}
 	return static_cast<int>(SDL_strlcpy(buf, result.c_str(), max_len));
 }
@@ -0,0 +1,454 @@
+/* 回归测试 - 在无窗口模式下绘制每一种图形、文本与混合模式，逐像素检查结果，
+   同时记录每个用例的耗时，结果以 JSON 格式输出到标准输出 */
+
+// 用法：xmake run test > report.json          比较并输出报告，有用例失败时返回值非 0
+//       xmake run test --update              绘制结果有意改变之后，重新生成全部参考图像
+//       xmake run test --filter blend        只运行名字中包含 blend 的用例
+// 用例分两种：
+// - 一致性用例把同一画面用另一条绘制路径（例如批量模式、逐个调用）当场再画一遍作为参考，不需要参考图像；
+// - 其余用例与 test/golden 中的参考图像比较。参考图像取决于平台与 SDL 版本，不随源码提供，
+//   没有参考图像的用例报告为 missing 但不算失败，先运行一次 --update 生成即可。
+// 不一致的用例会在 test/output 下留下实际结果与差异图（不一致的像素标为红色），便于对照。
+// 文本用例的参考图像取决于生成它的机器上解析到的字体（见 bgt_init_headless 的 font_name），
+// 换用字体不同的机器时需要先 --update。
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "libbgt.h"
+
+using namespace std;
+
+namespace {
+constexpr int kCanvasWidth = 128;
+constexpr int kCanvasHeight = 96;
+// 每个用例至少反复绘制这么久再计算平均耗时
+constexpr double kMinSeconds = 0.05;
+// 参考图像与同一个软件渲染器的结果应当完全一致，容差只为吸收 SDL 版本之间的取整差异
+constexpr int kTolerance = 2;
+
+const filesystem::path kGoldenDir = "test/golden";
+const filesystem::path kOutputDir = "test/output";
+
+struct Case {
+	string name;
+	// 从黑色的画布开始绘制，所有绘制函数都不刷新
+	function<void()> draw;
+	// 不为空时不使用参考图像，而是与这个函数当场绘制的结果比较
+	function<void()> expected;
+	int tolerance = kTolerance;
+};
+
+struct Result {
+	string name;
+	string status;
+	int mismatched_pixels;
+	double ns_per_op;
+	double ops_per_s;
+};
+
+vector<Case> cases;
+vector<Result> results;
+
+struct ModeInfo {
+	unsigned int mode;
+	const char* name;
+};
+
+const ModeInfo kModes[] = {
+	{ BGT_BLENDMODE_NONE, "none" },
+	{ BGT_BLENDMODE_BLEND, "blend" },
+	{ BGT_BLENDMODE_BLEND_PREMULTIPLIED, "blend_premultiplied" },
+	{ BGT_BLENDMODE_ADD, "add" },
+	{ BGT_BLENDMODE_ADD_PREMULTIPLIED, "add_premultiplied" },
+	{ BGT_BLENDMODE_MOD, "mod" },
+	{ BGT_BLENDMODE_MUL, "mul" },
+};
+
+// 混合模式用例的背景：四条不透明的竖条，覆盖暗、亮、彩色等情况
+void draw_stripes() {
+	const BGT_Rect stripes[] = {
+		{ 0, 0, 32, kCanvasHeight, 0, 0, 0, 255 },
+		{ 32, 0, 32, kCanvasHeight, 255, 255, 255, 255 },
+		{ 64, 0, 32, kCanvasHeight, 200, 40, 90, 255 },
+		{ 96, 0, 32, kCanvasHeight, 30, 160, 220, 255 },
+	};
+	bgt_rectangles(stripes, 4, false);
+}
+
+void draw_rectangles() {
+	bgt_rectangle(8, 8, 40, 30, 255, 0, 0, BGT_ALPHA_OPAQUE, false);
+	bgt_rectangle(30, 20, 40, 30, 0, 255, 0, 128, false);
+	bgt_rectangle(100, 70, 60, 60, 0, 0, 255, BGT_ALPHA_OPAQUE, false); // 超出画布的部分被裁剪
+	bgt_rectangle(-10, 60, 30, 20, 255, 255, 0, 200, false);
+	bgt_rectangle(60, 60, 1, 1, 255, 255, 255, BGT_ALPHA_OPAQUE, false);
+}
+
+void add_primitive_cases() {
+	cases.push_back({ "cls", [] { bgt_cls(40, 80, 120); } });
+	cases.push_back({ "rectangle", draw_rectangles });
+	// 批量模式只改变提交的时机，结果必须与立即绘制相同
+	cases.push_back({ "rectangle_batched", [] {
+		bgt_begin_batch();
+		draw_rectangles();
+		bgt_end_batch();
+	}, draw_rectangles });
+	cases.push_back({ "line", [] {
+		bgt_line(0, 0, 127, 95, 255, 255, 255, BGT_ALPHA_OPAQUE, false);
+		bgt_line(0, 95, 127, 0, 255, 0, 0, 128, false);
+		bgt_line(10, 48, 118, 48, 0, 255, 0, BGT_ALPHA_OPAQUE, false);
+		bgt_line(64, 5, 64, 90, 0, 128, 255, BGT_ALPHA_OPAQUE, false);
+		bgt_line(-20, 10, 150, 30, 255, 255, 0, BGT_ALPHA_OPAQUE, false);
+	} });
+	cases.push_back({ "circle", [] {
+		bgt_circle(40, 48, 30, 255, 0, 0, BGT_ALPHA_OPAQUE, false);
+		bgt_circle(70, 48, 30, 0, 0, 255, 128, false);
+		bgt_circle(110, 20, 1, 255, 255, 255, BGT_ALPHA_OPAQUE, false);
+		bgt_circle(120, 90, 20, 0, 255, 0, BGT_ALPHA_OPAQUE, false);
+	} });
+	cases.push_back({ "circle_outline", [] {
+		bgt_circle_outline(40, 48, 30, 255, 0, 0, BGT_ALPHA_OPAQUE, false);
+		bgt_circle_outline(70, 48, 30, 0, 128, 255, 128, false);
+		bgt_circle_outline(110, 20, 2, 255, 255, 255, BGT_ALPHA_OPAQUE, false);
+	} });
+	cases.push_back({ "ellipse", [] {
+		bgt_ellipse(50, 40, 45, 20, 255, 128, 0, BGT_ALPHA_OPAQUE, false);
+		bgt_ellipse(80, 60, 15, 35, 0, 200, 100, 128, false);
+	} });
+	cases.push_back({ "ellipse_outline", [] {
+		bgt_ellipse_outline(50, 40, 45, 20, 255, 128, 0, BGT_ALPHA_OPAQUE, false);
+		bgt_ellipse_outline(80, 60, 15, 35, 0, 200, 100, 128, false);
+	} });
+}
+
+// 批量绘制函数的输入，同时用于逐个调用的对照
+const vector<BGT_Rect>& bulk_rects() {
+	static vector<BGT_Rect> rects;
+	if (rects.empty()) {
+		for (int y = 0; y < 12; y++) {
+			for (int x = 0; x < 16; x++) {
+				rects.push_back({ x * 8, y * 8, 7, 7, static_cast<unsigned char>(x * 16),
+					static_cast<unsigned char>(y * 20), 128, static_cast<unsigned char>(x % 2 ? 255 : 128) });
+			}
+		}
+	}
+	return rects;
+}
+
+const vector<BGT_Line>& bulk_lines() {
+	static vector<BGT_Line> lines;
+	if (lines.empty()) {
+		for (int i = 0; i < 16; i++) {
+			lines.push_back({ 64, 48, i * 8, i % 2 ? 0 : 95, static_cast<unsigned char>(i * 16), 255,
+				static_cast<unsigned char>(255 - i * 16), 255 });
+		}
+	}
+	return lines;
+}
+
+const vector<BGT_Point>& bulk_points() {
+	static vector<BGT_Point> points;
+	if (points.empty()) {
+		for (int y = 0; y < kCanvasHeight; y += 3) {
+			for (int x = 0; x < kCanvasWidth; x += 3) {
+				points.push_back({ x, y, static_cast<unsigned char>(x * 2), static_cast<unsigned char>(y * 2),
+					255, 255 });
+			}
+		}
+	}
+	return points;
+}
+
+const vector<BGT_Circle>& bulk_circles() {
+	static vector<BGT_Circle> circles;
+	if (circles.empty()) {
+		for (int i = 0; i < 12; i++) {
+			circles.push_back({ 10 + i * 10, 20 + (i % 3) * 28, 4 + i % 5, 255,
+				static_cast<unsigned char>(i * 20), 0, static_cast<unsigned char>(i % 2 ? 255 : 160) });
+		}
+	}
+	return circles;
+}
+
+// 批量绘制函数的结果必须与逐个调用对应的单个绘制函数相同，批量模式下也一样
+void add_bulk_cases() {
+	const auto rects = [] {
+		bgt_rectangles(bulk_rects().data(), static_cast<int>(bulk_rects().size()), false);
+	};
+	const auto rects_one_by_one = [] {
+		for (const auto& e : bulk_rects()) {
+			bgt_rectangle(e.x, e.y, e.w, e.h, e.r, e.g, e.b, e.a, false);
+		}
+	};
+	cases.push_back({ "rectangles", rects, rects_one_by_one });
+	cases.push_back({ "rectangles_batched", [rects] {
+		bgt_begin_batch();
+		rects();
+		bgt_end_batch();
+	}, rects_one_by_one });
+
+	const auto lines = [] {
+		bgt_lines(bulk_lines().data(), static_cast<int>(bulk_lines().size()), false);
+	};
+	const auto lines_one_by_one = [] {
+		for (const auto& e : bulk_lines()) {
+			bgt_line(e.x1, e.y1, e.x2, e.y2, e.r, e.g, e.b, e.a, false);
+		}
+	};
+	cases.push_back({ "lines", lines, lines_one_by_one });
+	cases.push_back({ "lines_batched", [lines] {
+		bgt_begin_batch();
+		lines();
+		bgt_end_batch();
+	}, lines_one_by_one });
+
+	// 点就是 1x1 的矩形
+	const auto points = [] {
+		bgt_points(bulk_points().data(), static_cast<int>(bulk_points().size()), false);
+	};
+	const auto points_one_by_one = [] {
+		for (const auto& e : bulk_points()) {
+			bgt_rectangle(e.x, e.y, 1, 1, e.r, e.g, e.b, e.a, false);
+		}
+	};
+	cases.push_back({ "points", points, points_one_by_one });
+	cases.push_back({ "points_batched", [points] {
+		bgt_begin_batch();
+		points();
+		bgt_end_batch();
+	}, points_one_by_one });
+
+	const auto circles = [] {
+		bgt_circles(bulk_circles().data(), static_cast<int>(bulk_circles().size()), false);
+	};
+	const auto circles_one_by_one = [] {
+		for (const auto& e : bulk_circles()) {
+			bgt_circle(e.center_x, e.center_y, e.radius, e.r, e.g, e.b, e.a, false);
+		}
+	};
+	cases.push_back({ "circles", circles, circles_one_by_one });
+	cases.push_back({ "circles_batched", [circles] {
+		bgt_begin_batch();
+		circles();
+		bgt_end_batch();
+	}, circles_one_by_one });
+}
+
+void add_text_cases() {
+	cases.push_back({ "text_ascii", [] {
+		bgt_show_str(2, 2, "Hello, libbgt!", 255, 255, 255, BGT_ALPHA_OPAQUE, false);
+		bgt_show_str(2, 30, "0123456789", 255, 255, 0, BGT_ALPHA_OPAQUE, false);
+	} });
+	cases.push_back({ "text_cjk", [] {
+		bgt_show_str(2, 2, "同济大学", 255, 255, 255, BGT_ALPHA_OPAQUE, false);
+		bgt_show_str(2, 30, "中英 mixed", 0, 255, 128, BGT_ALPHA_OPAQUE, false);
+	} });
+	cases.push_back({ "text_translucent", [] {
+		bgt_rectangle(0, 0, 64, kCanvasHeight, 200, 40, 90, BGT_ALPHA_OPAQUE, false);
+		bgt_show_str(2, 30, "alpha 128", 255, 255, 255, 128, false);
+	} });
+	cases.push_back({ "text_cout", [] {
+		bgt_cout(2, 2, 255, 255, 255, BGT_ALPHA_OPAQUE, false) << "PI=" << fixed << setprecision(3) << 3.1415926;
+		bgt_cout(2, 30, 128, 200, 255, BGT_ALPHA_OPAQUE, false) << 42 << ' ' << -7;
+	} });
+}
+
+void add_blend_cases() {
+	for (const auto& info : kModes) {
+		const unsigned int mode = info.mode;
+		cases.push_back({ string("blend_") + info.name, [mode] {
+			draw_stripes();
+			bgt_set_blend_mode(mode);
+			bgt_rectangle(8, 8, 112, 30, 96, 64, 32, 128, false);
+			bgt_circle(64, 66, 24, 32, 128, 96, 200, false);
+			bgt_set_blend_mode(BGT_BLENDMODE_BLEND);
+		} });
+	}
+
+	// 像素内核与渲染器的公式相同、取整方式不同，结果最多相差 2（见 bgt_pixels_fill_rect）
+	for (const auto& info : kModes) {
+		const unsigned int mode = info.mode;
+		Case pixels_case{ string("pixels_fill_") + info.name, [mode] {
+			draw_stripes();
+			bgt_set_blend_mode(mode);
+			int pitch;
+			if (bgt_lock_pixels(pitch)) {
+				bgt_pixels_fill_rect(8, 8, 112, 80, 96, 64, 32, 128);
+				bgt_unlock_pixels(false);
+			}
+			bgt_set_blend_mode(BGT_BLENDMODE_BLEND);
+		} };
+		pixels_case.expected = [mode] {
+			draw_stripes();
+			bgt_set_blend_mode(mode);
+			bgt_rectangle(8, 8, 112, 80, 96, 64, 32, 128, false);
+			bgt_set_blend_mode(BGT_BLENDMODE_BLEND);
+		};
+		cases.push_back(move(pixels_case));
+	}
+
+	cases.push_back({ "layer_composite", [] {
+		draw_stripes();
+		static int layer = 0;
+		if (!layer) {
+			layer = bgt_create_layer(64, 48);
+		}
+		bgt_set_draw_layer(layer);
+		bgt_clear_layer(layer);
+		bgt_circle(32, 24, 20, 255, 200, 0, 160, false);
+		bgt_set_draw_layer(BGT_CANVAS);
+		bgt_composite_layer(layer, 10, 10, BGT_ALPHA_OPAQUE, BGT_BLENDMODE_BLEND_PREMULTIPLIED, false);
+		bgt_composite_layer(layer, 60, 40, 128, BGT_BLENDMODE_BLEND_PREMULTIPLIED, false);
+	} });
+}
+
+void run_from_black(const function<void()>& draw) {
+	bgt_cls(0, 0, 0, false);
+	draw();
+}
+
+// 反复绘制直到累计时间足够长；每轮执行次数翻倍，以减少读取时钟的开销
+void measure(Result& result, const function<void()>& draw) {
+	using clock = chrono::steady_clock;
+	run_from_black(draw); // 预热，让各种缓存进入稳定状态
+	long long ops = 0;
+	long long batch = 1;
+	auto start = clock::now();
+	double elapsed = 0;
+	do {
+		for (long long i = 0; i < batch; i++) {
+			run_from_black(draw);
+		}
+		ops += batch;
+		batch *= 2;
+		elapsed = chrono::duration<double>(clock::now() - start).count();
+	} while (elapsed < kMinSeconds);
+	result.ns_per_op = elapsed * 1e9 / ops;
+	result.ops_per_s = ops / elapsed;
+}
+
+Result run_case(const Case& test, bool update) {
+	Result result{ test.name, "pass", 0, 0, 0 };
+	measure(result, test.draw);
+
+	// 测试文件的路径都是 ASCII，直接传给 bgt_* 函数即可
+	string golden = (kGoldenDir / (test.name + ".png")).string();
+	if (test.expected) {
+		golden = (kOutputDir / (test.name + ".expected.ppm")).string();
+		run_from_black(test.expected);
+		if (!bgt_save_frame(golden.c_str())) {
+			result.status = "error";
+			cerr << test.name << ": " << bgt_get_error() << "\n";
+			return result;
+		}
+	}
+	run_from_black(test.draw);
+
+	if (update && !test.expected) {
+		result.status = bgt_save_frame(golden.c_str()) ? "updated" : "error";
+	}
+	else if (!filesystem::exists(golden)) {
+		result.status = "missing";
+	}
+	else {
+		const string diff = (kOutputDir / (test.name + ".diff.png")).string();
+		if (!bgt_compare_frame(golden.c_str(), test.tolerance, result.mismatched_pixels, diff.c_str())) {
+			result.status = "error";
+		}
+		else if (result.mismatched_pixels > 0) {
+			result.status = "fail";
+			bgt_save_frame((kOutputDir / (test.name + ".actual.png")).string().c_str());
+		}
+		else {
+			filesystem::remove(diff);
+		}
+	}
+	if (result.status == "error") {
+		cerr << test.name << ": " << bgt_get_error() << "\n";
+	}
+	return result;
+}
+
+int count_status(string_view status) {
+	int count = 0;
+	for (const auto& r : results) {
+		count += r.status == status;
+	}
+	return count;
+}
+
+void print_json() {
+	cout << "{\n  \"renderer\": \"" << bgt_get_renderer_name() << "\",\n"
+		<< "  \"passed\": " << count_status("pass") << ",\n"
+		<< "  \"failed\": " << count_status("fail") + count_status("error") << ",\n"
+		<< "  \"missing\": " << count_status("missing") << ",\n"
+		<< "  \"cases\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result& r = results[i];
+		cout << "    {\"name\": \"" << r.name << "\", \"status\": \"" << r.status << "\", "
+			<< "\"mismatched_pixels\": " << r.mismatched_pixels << ", " << fixed << setprecision(2)
+			<< "\"ns_per_op\": " << r.ns_per_op << ", "
+			<< "\"ops_per_s\": " << r.ops_per_s << "}"
+			<< (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	cout << "  ]\n}\n";
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+	bool update = false;
+	string filter;
+	for (int i = 1; i < argc; i++) {
+		const string_view arg = argv[i];
+		if (arg == "--update") {
+			update = true;
+		}
+		else if (arg == "--filter" && i + 1 < argc) {
+			filter = argv[++i];
+		}
+		else {
+			cerr << "usage: " << argv[0] << " [--update] [--filter SUBSTRING]\n";
+			return 2;
+		}
+	}
+
+	if (!bgt_init_headless(kCanvasWidth, kCanvasHeight)) {
+		cerr << "bgt_init_headless failed: " << bgt_get_error() << "\n";
+		return 1;
+	}
+	filesystem::create_directories(kGoldenDir);
+	filesystem::create_directories(kOutputDir);
+
+	add_primitive_cases();
+	add_bulk_cases();
+	add_text_cases();
+	add_blend_cases();
+
+	for (const auto& test : cases) {
+		if (test.name.find(filter) == string::npos) {
+			continue;
+		}
+		results.push_back(run_case(test, update));
+		const Result& r = results.back();
+		cerr << left << setw(28) << r.name << setw(10) << r.status << right << fixed << setprecision(1)
+			<< setw(12) << r.ns_per_op << " ns/op";
+		if (r.mismatched_pixels > 0) {
+			cerr << "  (" << r.mismatched_pixels << " pixels differ)";
+		}
+		cerr << "\n";
+	}
+	const int failed = count_status("fail") + count_status("error");
+	if (const int missing = count_status("missing"); missing > 0) {
+		cerr << missing << " case(s) have no reference image; create them with --update\n";
+	}
+
+	print_json();
+	bgt_quit();
+	return failed > 0 ? 1 : 0;
+}
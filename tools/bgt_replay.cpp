@@ -0,0 +1,415 @@
+/* 回放工具 - 在无窗口模式下尽快重新执行 bgt_start_recording 录制的调用，结果以 JSON 格式输出到标准输出 */
+
+// 用法：xmake run replay <录制文件> [--repeat 次数] [--save 最后一帧.png]
+// 输入事件只是记录下来供参考，回放时跳过，只重现输入框结束时对画布的擦除；bgt_delay 等待的时间也跳过
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "libbgt.h"
+#include <internal/call_recorder.h>
+
+using namespace std;
+
+namespace {
+struct Options {
+	string recording;
+	int repeat = 1;
+	string save_path;
+};
+
+struct Stats {
+	long long calls = 0;
+	Uint64 recorded_ns = 0;
+};
+
+// 参数的求值顺序不确定，必须先按顺序读出来再调用
+template <size_t N>
+array<int, N> read_ints(CallReader& reader) {
+	array<int, N> values{};
+	for (auto& value : values) {
+		value = static_cast<int>(reader.getInt());
+	}
+	return values;
+}
+
+// 写成 JSON 字符串：Windows 路径中的反斜杠等字符需要转义
+string json_string(const string& text) {
+	string out = "\"";
+	for (const char ch : text) {
+		switch (ch) {
+		case '"':
+			out += "\\\"";
+			break;
+		case '\\':
+			out += "\\\\";
+			break;
+		default:
+			if (static_cast<unsigned char>(ch) < 0x20) {
+				char escaped[8];
+				snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+				out += escaped;
+			}
+			else {
+				out += ch;
+			}
+		}
+	}
+	return out + '"';
+}
+
+Uint8 to_channel(int value) {
+	return static_cast<Uint8>(value);
+}
+
+template <size_t N>
+void skip_ints(CallReader& reader) {
+	read_ints<N>(reader);
+}
+
+bool replay_bulk(CallOp op, CallReader& reader) {
+	const auto [count, flush] = read_ints<2>(reader);
+	if (count < 0 || reader.failed()) {
+		return false;
+	}
+	switch (op) {
+	case CallOp::Rectangles: {
+		vector<BGT_Rect> rects(count);
+		for (auto& e : rects) {
+			const auto v = read_ints<8>(reader);
+			e = { v[0], v[1], v[2], v[3], to_channel(v[4]), to_channel(v[5]), to_channel(v[6]), to_channel(v[7]) };
+		}
+		return bgt_rectangles(rects.data(), count, flush != 0);
+	}
+	case CallOp::Lines: {
+		vector<BGT_Line> lines(count);
+		for (auto& e : lines) {
+			const auto v = read_ints<8>(reader);
+			e = { v[0], v[1], v[2], v[3], to_channel(v[4]), to_channel(v[5]), to_channel(v[6]), to_channel(v[7]) };
+		}
+		return bgt_lines(lines.data(), count, flush != 0);
+	}
+	case CallOp::Points: {
+		vector<BGT_Point> points(count);
+		for (auto& e : points) {
+			const auto v = read_ints<6>(reader);
+			e = { v[0], v[1], to_channel(v[2]), to_channel(v[3]), to_channel(v[4]), to_channel(v[5]) };
+		}
+		return bgt_points(points.data(), count, flush != 0);
+	}
+	default: {
+		vector<BGT_Circle> circles(count);
+		for (auto& e : circles) {
+			const auto v = read_ints<7>(reader);
+			e = { v[0], v[1], v[2], to_channel(v[3]), to_channel(v[4]), to_channel(v[5]), to_channel(v[6]) };
+		}
+		return bgt_circles(circles.data(), count, flush != 0);
+	}
+	}
+}
+
+// 录制的 bgt_lock_pixels 在回放时同样加锁，记下缓冲区以便解锁时写入录制的像素
+unsigned int* locked_pixels = nullptr;
+int locked_pitch = 0;
+
+bool replay_unlock(CallReader& reader) {
+	const auto [w, h, flush] = read_ints<3>(reader);
+	const auto pixels = reader.getPixels(size_t(max(w, 0)) * size_t(max(h, 0)));
+	unsigned int* dst = locked_pixels;
+	int pitch = locked_pitch;
+	locked_pixels = nullptr;
+	if (!dst) {
+		dst = bgt_lock_pixels(pitch);
+	}
+	// 画布大小与录制时不同说明文件有问题，不能按原来的大小写入
+	if (!dst || w > pitch) {
+		if (dst) {
+			bgt_unlock_pixels(false);
+		}
+		return false;
+	}
+	for (int y = 0; y < h && !pixels.empty(); y++) {
+		memcpy(dst + size_t(y) * pitch, pixels.data() + size_t(y) * w, size_t(w) * sizeof(Uint32));
+	}
+	return bgt_unlock_pixels(flush != 0);
+}
+
+// 执行一条记录；绘制失败不影响回放，只有文件本身有问题才停止
+bool replay_call(CallOp op, CallReader& reader, const Options& options, bool last_iteration) {
+	switch (op) {
+	case CallOp::Init:
+	case CallOp::InitHeadless: {
+		const auto [w, h, font_size] = read_ints<3>(reader);
+		const string font_name = reader.getString();
+		if (reader.failed()) {
+			return false;
+		}
+		bgt_quit();
+		locked_pixels = nullptr;
+		if (!bgt_init_headless(w, h, font_name.c_str(), font_size)) {
+			cerr << "bgt_init_headless failed: " << bgt_get_error() << "\n";
+			return false;
+		}
+		return true;
+	}
+	case CallOp::Quit:
+		if (last_iteration && !options.save_path.empty() && !bgt_save_frame(options.save_path.c_str())) {
+			cerr << "cannot save " << options.save_path << ": " << bgt_get_error() << "\n";
+		}
+		bgt_quit();
+		locked_pixels = nullptr;
+		return true;
+	case CallOp::Cls: {
+		const auto v = read_ints<4>(reader);
+		bgt_cls(v[0], v[1], v[2], v[3] != 0);
+		return true;
+	}
+	case CallOp::Rectangle: {
+		const auto v = read_ints<9>(reader);
+		bgt_rectangle(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8] != 0);
+		return true;
+	}
+	case CallOp::Line: {
+		const auto v = read_ints<9>(reader);
+		bgt_line(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8] != 0);
+		return true;
+	}
+	case CallOp::Circle:
+	case CallOp::CircleOutline: {
+		const auto v = read_ints<8>(reader);
+		auto* draw = op == CallOp::Circle ? bgt_circle : bgt_circle_outline;
+		draw(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7] != 0);
+		return true;
+	}
+	case CallOp::Ellipse:
+	case CallOp::EllipseOutline: {
+		const auto v = read_ints<9>(reader);
+		auto* draw = op == CallOp::Ellipse ? bgt_ellipse : bgt_ellipse_outline;
+		draw(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8] != 0);
+		return true;
+	}
+	case CallOp::SetBlendMode:
+		bgt_set_blend_mode(static_cast<unsigned int>(read_ints<1>(reader)[0]));
+		return true;
+	case CallOp::Rectangles:
+	case CallOp::Lines:
+	case CallOp::Points:
+	case CallOp::Circles:
+		return replay_bulk(op, reader) || !reader.failed();
+	case CallOp::ShowStr: {
+		const auto v = read_ints<7>(reader);
+		const string str = reader.getString();
+		bgt_show_str(v[0], v[1], str.c_str(), v[2], v[3], v[4], v[5], v[6] != 0);
+		return !reader.failed();
+	}
+	case CallOp::MeasureText: {
+		const string str = reader.getString();
+		bgt_measure_text(str.data(), static_cast<int>(str.size()));
+		return !reader.failed();
+	}
+	case CallOp::Flush:
+		bgt_flush();
+		return true;
+	case CallOp::SetFrameRate:
+		bgt_set_frame_rate(read_ints<1>(reader)[0]);
+		return true;
+	case CallOp::Delay:
+		skip_ints<1>(reader);
+		return true;
+	case CallOp::BeginBatch:
+		bgt_begin_batch();
+		return true;
+	case CallOp::EndBatch:
+		bgt_end_batch();
+		return true;
+	case CallOp::SetTextCacheBudget:
+		bgt_set_text_cache_budget(reader.getUint());
+		return true;
+	case CallOp::PixelsFillRect: {
+		const auto v = read_ints<8>(reader);
+		bgt_pixels_fill_rect(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7]);
+		return true;
+	}
+	case CallOp::PixelsBlit: {
+		const auto [x, y, w, h] = read_ints<4>(reader);
+		const auto pixels = reader.getPixels(size_t(w) * size_t(h));
+		if (!pixels.empty()) {
+			bgt_pixels_blit(pixels.data(), w, x, y, w, h);
+		}
+		return !reader.failed();
+	}
+	case CallOp::LockPixels:
+		locked_pixels = bgt_lock_pixels(locked_pitch);
+		return true;
+	case CallOp::UnlockPixels:
+		replay_unlock(reader);
+		return !reader.failed();
+	case CallOp::Getch:
+		skip_ints<1>(reader);
+		return true;
+	case CallOp::InputNumber:
+	case CallOp::InputAscii: {
+		const auto v = read_ints<7>(reader);
+		if (op == CallOp::InputNumber) {
+			skip_ints<1>(reader);
+		}
+		else {
+			reader.getString();
+		}
+		bgt_rectangle(v[0], v[1], v[2], v[3], v[4], v[5], v[6]);
+		return !reader.failed();
+	}
+	case CallOp::ReadKeyboardAndMouse:
+		skip_ints<6>(reader);
+		return true;
+	case CallOp::ReadEvents: {
+		const int count = read_ints<1>(reader)[0];
+		for (int i = 0; i < count && !reader.failed(); i++) {
+			skip_ints<6>(reader);
+		}
+		return !reader.failed();
+	}
+	// 图层按创建的顺序编号，回放时得到的编号与录制时相同
+	case CallOp::CreateLayer: {
+		const auto [w, h] = read_ints<2>(reader);
+		bgt_create_layer(w, h);
+		return true;
+	}
+	case CallOp::DestroyLayer:
+		bgt_destroy_layer(read_ints<1>(reader)[0]);
+		return true;
+	case CallOp::SetDrawLayer:
+		bgt_set_draw_layer(read_ints<1>(reader)[0]);
+		return true;
+	case CallOp::ClearLayer:
+		bgt_clear_layer(read_ints<1>(reader)[0]);
+		return true;
+	case CallOp::CompositeLayer: {
+		const auto v = read_ints<6>(reader);
+		bgt_composite_layer(v[0], v[1], v[2], v[3], static_cast<unsigned int>(v[4]), v[5] != 0);
+		return true;
+	}
+	// 图片按录制时的路径加载，需要在同样的工作目录下回放
+	case CallOp::LoadImage: {
+		const string path = reader.getString();
+		if (!reader.failed() && !bgt_load_image(path.c_str())) {
+			cerr << "cannot load image " << path << ": " << bgt_get_error() << "\n";
+		}
+		return !reader.failed();
+	}
+	case CallOp::SetImageAtlasSize:
+		bgt_set_image_atlas_size(read_ints<1>(reader)[0]);
+		return true;
+	case CallOp::FreeImage:
+		bgt_free_image(read_ints<1>(reader)[0]);
+		return true;
+	case CallOp::DrawImages: {
+		const auto [count, flush] = read_ints<2>(reader);
+		if (count < 0) {
+			return false;
+		}
+		vector<BGT_Sprite> sprites(count);
+		for (auto& e : sprites) {
+			const auto v = read_ints<13>(reader);
+			e = { v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8],
+				to_channel(v[9]), to_channel(v[10]), to_channel(v[11]), to_channel(v[12]) };
+		}
+		if (!reader.failed()) {
+			bgt_draw_images(sprites.data(), count, flush != 0);
+		}
+		return !reader.failed();
+	}
+	}
+	cerr << "unknown call " << int(op) << " in recording\n";
+	return false;
+}
+
+bool replay_once(CallReader& reader, const Options& options, bool last_iteration, Stats& stats) {
+	reader.rewind();
+	stats = {};
+	locked_pixels = nullptr;
+	CallOp op;
+	Uint64 delta_ns;
+	while (reader.next(op, delta_ns)) {
+		stats.calls++;
+		stats.recorded_ns += delta_ns;
+		if (!replay_call(op, reader, options, last_iteration)) {
+			break;
+		}
+	}
+	if (reader.failed()) {
+		cerr << "bad recording: " << bgt_get_error() << "\n";
+		return false;
+	}
+	// 录制的程序没有调用 bgt_quit（例如中途崩溃）时，最后一帧在这里保存
+	if (last_iteration && !options.save_path.empty() && bgt_save_frame(options.save_path.c_str())) {
+		cerr << "saved " << options.save_path << "\n";
+	}
+	bgt_quit();
+	return true;
+}
+
+bool parse_options(int argc, char* argv[], Options& options) {
+	for (int i = 1; i < argc; i++) {
+		const string arg = argv[i];
+		if (arg == "--repeat" && i + 1 < argc) {
+			options.repeat = max(1, atoi(argv[++i]));
+		}
+		else if (arg == "--save" && i + 1 < argc) {
+			options.save_path = argv[++i];
+		}
+		else if (options.recording.empty() && arg[0] != '-') {
+			options.recording = arg;
+		}
+		else {
+			return false;
+		}
+	}
+	return !options.recording.empty();
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+	Options options;
+	if (!parse_options(argc, argv, options)) {
+		cerr << "usage: " << argv[0] << " <recording> [--repeat N] [--save frame.png]\n";
+		return 2;
+	}
+	CallReader reader;
+	if (!reader.open(options.recording.c_str())) {
+		cerr << "cannot open " << options.recording << ": " << bgt_get_error() << "\n";
+		return 1;
+	}
+
+	using clock = chrono::steady_clock;
+	Stats stats;
+	double best_ms = 0, total_ms = 0;
+	for (int i = 0; i < options.repeat; i++) {
+		const auto start = clock::now();
+		if (!replay_once(reader, options, i + 1 == options.repeat, stats)) {
+			return 1;
+		}
+		const double ms = chrono::duration<double, milli>(clock::now() - start).count();
+		best_ms = i == 0 ? ms : min(best_ms, ms);
+		total_ms += ms;
+		cerr << "iteration " << i + 1 << ": " << fixed << setprecision(2) << ms << " ms\n";
+	}
+
+	const double mean_ms = total_ms / options.repeat;
+	cout << fixed << setprecision(3)
+		<< "{\"recording\": " << json_string(options.recording) << ", "
+		<< "\"iterations\": " << options.repeat << ", "
+		<< "\"calls\": " << stats.calls << ", "
+		<< "\"recorded_ms\": " << stats.recorded_ns / 1e6 << ", "
+		<< "\"replay_mean_ms\": " << mean_ms << ", "
+		<< "\"replay_best_ms\": " << best_ms << ", "
+		<< "\"ns_per_call\": " << (stats.calls ? mean_ms * 1e6 / stats.calls : 0) << "}\n";
+	return 0;
+}
@@ -1,7 +1,7 @@
 add_rules("mode.debug", "mode.release")
 add_rules("plugin.compile_commands.autoupdate", {outputdir = "build"})
 
-add_requires("libsdl3_ttf", "fontconfig", {configs = {shared = false}, debug = is_mode("debug")})
+add_requires("libsdl3_ttf", "libsdl3_image", "fontconfig", {configs = {shared = false}, debug = is_mode("debug")})
 
 set_encodings("source:utf-8")
 
@@ -17,7 +17,7 @@ target("libbgt")
     add_includedirs("include/", {public = true})
     add_headerfiles("include/*.h")
     add_headerfiles("include/internal/*.h", {install = false})
-    add_packages("libsdl3_ttf", "fontconfig")
+    add_packages("libsdl3_ttf", "libsdl3_image", "fontconfig")
 
     if has_config("use_ansi") then
         add_defines("USE_ANSI")
@@ -55,3 +55,27 @@ target("demo")
     add_files("demo/**.cpp")
     add_deps("libbgt")
 
+target("bench")
+    set_default(false)
+    set_languages("c++latest")
+    set_kind("binary")
+    add_files("bench/**.cpp")
+    add_deps("libbgt")
+    add_packages("libsdl3_ttf")
+
+target("replay")
+    set_default(false)
+    set_languages("c++latest")
+    set_kind("binary")
+    add_files("tools/**.cpp")
+    add_deps("libbgt")
+    add_packages("libsdl3_ttf")
+
+target("test")
+    set_default(false)
+    set_languages("c++latest")
+    set_kind("binary")
+    add_files("test/**.cpp")
+    add_deps("libbgt")
+    add_packages("libsdl3_ttf")
+    set_rundir("$(projectdir)")